@@ -0,0 +1,69 @@
+#pragma once
+
+// Backbone tracking: edges that every recent local optimum agrees on are unlikely to leave the tour,
+// so searching from their points is mostly wasted. Each accepted local optimum updates the point
+// adjacency it was compared with; an edge is a backbone edge once both its points have kept their
+// adjacents through threshold consecutive accepted local optima. Freezing backbone edges
+// (IteratedLocalSearch::freeze) makes points whose both edges are frozen inactive in the climbs.
+
+#include "primitives.hh"
+#include "tour.hh"
+
+#include <array>
+#include <utility> // pair
+#include <vector>
+
+class Backbone {
+ public:
+    using Edge = std::pair<primitives::point_id_t, primitives::point_id_t>;
+
+    Backbone(const Tour &tour, size_t threshold)
+        : threshold_(threshold), adjacents_(tour.adjacents()), since_(tour.size(), 0) {}
+
+    // Records an accepted local optimum; points (if not nullptr) must include every point whose adjacents changed.
+    void update(const Tour &tour, const std::vector<primitives::point_id_t> *points) {
+        ++optima_;
+        if (points) {
+            for (auto p : *points) {
+                update(tour, p);
+            }
+            return;
+        }
+        for (primitives::point_id_t p{0}; p < tour.size(); ++p) {
+            update(tour, p);
+        }
+    }
+
+    // Backbone edges of tour; frozen_points is set to the number of points whose both edges are backbone edges.
+    std::vector<Edge> edges(const Tour &tour, size_t &frozen_points) const {
+        std::vector<Edge> edges;
+        frozen_points = 0;
+        for (primitives::point_id_t p{0}; p < tour.size(); ++p) {
+            if (stable(p) and stable(tour.next(p))) {
+                edges.emplace_back(p, tour.next(p));
+            }
+            if (stable(p) and stable(tour.next(p)) and stable(tour.prev(p))) {
+                ++frozen_points;
+            }
+        }
+        return edges;
+    }
+
+ private:
+    const size_t threshold_;
+    size_t optima_{0}; // accepted local optima.
+    std::vector<std::array<primitives::point_id_t, 2>> adjacents_; // as of the last update.
+    std::vector<size_t> since_; // accepted local optima count when the adjacents of each point last changed.
+
+    bool stable(primitives::point_id_t p) const { return optima_ - since_[p] >= threshold_; }
+
+    void update(const Tour &tour, primitives::point_id_t p) {
+        const auto &a = adjacents_[p];
+        const auto &b = tour.adjacents()[p];
+        if ((a[0] == b[0] and a[1] == b[1]) or (a[0] == b[1] and a[1] == b[0])) {
+            return;
+        }
+        adjacents_[p] = b;
+        since_[p] = optima_;
+    }
+};
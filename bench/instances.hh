@@ -0,0 +1,122 @@
+#pragma once
+
+// Reproducible synthetic instances (integer coordinates in [0, SIDE]) for benchmarks:
+// - uniform: independent uniform points.
+// - clustered: normally distributed around sqrt(n) / 4 uniform centers (as in the DIMACS clustered instances).
+// - vlsi: distinct points on a lattice, inside random rectangular blocks of various sizes, so that rows and
+//   columns of equally spaced points and empty channels alternate (as in the VLSI instances, e.g. lrb744710).
+
+#include "primitives.hh"
+
+#include <algorithm> // clamp, max, min, shuffle, sort, unique
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+enum class Distribution {uniform, clustered, vlsi};
+
+constexpr primitives::space_t SIDE{1e6};
+
+inline Distribution parse_distribution(const std::string &name) {
+    if (name == "uniform") {
+        return Distribution::uniform;
+    }
+    if (name == "clustered") {
+        return Distribution::clustered;
+    }
+    if (name == "vlsi") {
+        return Distribution::vlsi;
+    }
+    throw std::invalid_argument("unrecognized distribution: " + name);
+}
+
+inline std::string name(Distribution distribution) {
+    switch (distribution) {
+        case Distribution::uniform: return "uniform";
+        case Distribution::clustered: return "clustered";
+        case Distribution::vlsi: return "vlsi";
+    }
+    return "";
+}
+
+inline std::array<std::vector<primitives::space_t>, 2> make_instance(Distribution distribution
+    , primitives::point_id_t n
+    , std::uint32_t seed = 0) {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<primitives::space_t> coordinate(0, SIDE);
+    std::array<std::vector<primitives::space_t>, 2> xy;
+    auto &[x, y] = xy;
+    x.reserve(n);
+    y.reserve(n);
+    const auto add = [&x, &y](primitives::space_t px, primitives::space_t py) {
+        x.push_back(std::round(std::clamp(px, primitives::space_t{0}, SIDE)));
+        y.push_back(std::round(std::clamp(py, primitives::space_t{0}, SIDE)));
+    };
+    if (distribution == Distribution::uniform) {
+        for (primitives::point_id_t i{0}; i < n; ++i) {
+            add(coordinate(generator), coordinate(generator));
+        }
+    } else if (distribution == Distribution::clustered) {
+        const size_t cluster_count = std::max<size_t>(1, std::sqrt(n) / 4);
+        std::vector<std::array<primitives::space_t, 2>> centers(cluster_count);
+        for (auto &center : centers) {
+            center = {coordinate(generator), coordinate(generator)};
+        }
+        std::uniform_int_distribution<size_t> cluster(0, cluster_count - 1);
+        std::normal_distribution<primitives::space_t> offset(0, SIDE / std::sqrt(cluster_count) / 8);
+        for (primitives::point_id_t i{0}; i < n; ++i) {
+            const auto &center = centers[cluster(generator)];
+            add(center[0] + offset(generator), center[1] + offset(generator));
+        }
+    } else {
+        // lattice with about 8 cells per point, so that blocks covering part of the domain hold n points.
+        const std::uint64_t cells_per_side = std::max<std::uint64_t>(2, std::sqrt(8.0 * n));
+        const primitives::space_t pitch = SIDE / cells_per_side;
+        std::uniform_int_distribution<std::uint64_t> cell(0, cells_per_side - 1);
+        std::uniform_int_distribution<std::uint64_t> block_side(1, std::max<std::uint64_t>(1, cells_per_side / 16));
+        std::vector<std::uint64_t> cells; // row * cells_per_side + column.
+        while (cells.size() < n) {
+            const auto row = cell(generator);
+            const auto column = cell(generator);
+            const auto rows = block_side(generator);
+            const auto columns = block_side(generator);
+            // every other row of a block, like the rows of cells in a circuit layout.
+            for (auto r = row; r < std::min(row + rows, cells_per_side); r += 2) {
+                for (auto c = column; c < std::min(column + columns, cells_per_side); ++c) {
+                    cells.push_back(r * cells_per_side + c);
+                }
+            }
+            if (cells.size() >= n) {
+                std::sort(std::begin(cells), std::end(cells));
+                cells.erase(std::unique(std::begin(cells), std::end(cells)), std::end(cells));
+            }
+        }
+        std::shuffle(std::begin(cells), std::end(cells), generator);
+        cells.resize(n);
+        for (const auto &c : cells) {
+            add((c % cells_per_side) * pitch, (c / cells_per_side) * pitch);
+        }
+    }
+    return xy;
+}
+
+// Writes a TSPLIB file (EUC_2D) that fileio::read_coordinates reads.
+inline void write_tsp(const std::string &path
+    , const std::vector<primitives::space_t> &x
+    , const std::vector<primitives::space_t> &y) {
+    std::ofstream file(path, std::ofstream::out);
+    file << "NAME : synthetic\nTYPE : TSP\nDIMENSION : " << x.size() << "\nEDGE_WEIGHT_TYPE : EUC_2D\nNODE_COORD_SECTION\n";
+    for (size_t i{0}; i < x.size(); ++i) {
+        file << i + 1 << ' ' << static_cast<std::int64_t>(x[i]) << ' ' << static_cast<std::int64_t>(y[i]) << '\n';
+    }
+    file << "EOF\n";
+}
+
+}  // namespace bench
@@ -0,0 +1,232 @@
+// Micro-benchmarks of the hot kernels on reproducible synthetic instances (see instances.hh), one line per
+// kernel, distribution and size: "kernel <name> distribution <d> points <n> ops <count> ns_per_op <t> checksum <c>".
+// The checksum depends only on the seeded inputs, so that lines of different versions are comparable.
+// - length: LengthCalculator of random point pairs.
+// - get_points: quadtree query (Node::get_points) of the square of 3 mean tour edges around a random point.
+// - feasible: cycle_check::feasible of random 5-swaps.
+// - swap: Tour::swap of random 5-swaps (O(n) each).
+// - find_best: HillClimber::find_best calls of a 3-opt climb from a space-filling curve tour (moves applied untimed).
+// - merge: merge::merge of a tour with 1000 reversed short segments into the unreversed tour.
+// - parse: fileio::read_coordinates, per point.
+//
+// Usage: kernels.out [max_points (10000 to 10000000)] [distribution (uniform, clustered, vlsi or all)]
+
+#include "NanoTimer.h"
+#include "bench/instances.hh"
+#include "cycle_check.hh"
+#include "fileio.hh"
+#include "hill_climber.hh"
+#include "kmove.hh"
+#include "length_calculator.hh"
+#include "merge/merge.hh"
+#include "perturb.hh"
+#include "point_quadtree/Domain.h"
+#include "point_quadtree/point_quadtree.h"
+#include "point_set.hh"
+#include "primitives.hh"
+#include "randomize/randomize.hh"
+#include "relabel.hh"
+#include "tour.hh"
+
+#include <algorithm> // max, min, reverse
+#include <cstdint>
+#include <cstdio> // remove
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t KMAX{3};
+constexpr size_t SWAP_K{5};
+
+struct Instance {
+    std::string distribution;
+    std::vector<primitives::space_t> x, y;
+};
+
+void report(const std::string &kernel, const Instance &instance, size_t ops, double nanoseconds, std::uint64_t checksum) {
+    std::cout << "kernel " << kernel
+        << " distribution " << instance.distribution
+        << " points " << instance.x.size()
+        << " ops " << ops
+        << " ns_per_op " << nanoseconds / ops
+        << " checksum " << checksum
+        << std::endl;
+}
+
+// random kswaps of tour; fixed by the randomize seed.
+std::vector<KMove> make_kswaps(const Tour &tour, size_t count) {
+    std::vector<KMove> kswaps;
+    for (size_t i{0}; i < count; ++i) {
+        kswaps.push_back(perturb::kswap(tour.order(), randomize::sequence(tour.size()), SWAP_K));
+    }
+    return kswaps;
+}
+
+void run(const Instance &instance) {
+    const auto &x = instance.x;
+    const auto &y = instance.y;
+    const primitives::point_id_t n = x.size();
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<primitives::point_id_t> point(0, n - 1);
+    randomize::seed(1);
+
+    {
+        constexpr size_t OPS{1 << 22};
+        const LengthCalculator length_calculator(x, y);
+        std::vector<primitives::point_id_t> pairs(2 * OPS);
+        for (auto &p : pairs) {
+            p = point(generator);
+        }
+        std::uint64_t checksum{0};
+        NanoTimer timer;
+        timer.start();
+        for (size_t i{0}; i < OPS; ++i) {
+            checksum += length_calculator(pairs[2 * i], pairs[2 * i + 1]);
+        }
+        report("length", instance, OPS, timer.stop(), checksum);
+    }
+
+    const point_quadtree::Domain domain(x, y);
+    // make_quadtree reports stats on std::cout.
+    std::stringstream discarded;
+    auto *cout_buffer = std::cout.rdbuf(discarded.rdbuf());
+    const auto root = point_quadtree::make_quadtree(x, y, domain);
+    std::cout.rdbuf(cout_buffer);
+    const PointSet point_set(root, x, y);
+    const auto order = relabel::make_relabeling(x, y, relabel::Curve::hilbert).new_to_old;
+    const Tour curve_tour(&domain, order);
+
+    {
+        constexpr size_t OPS{1 << 16};
+        const primitives::length_t radius = 3 * curve_tour.length() / n;
+        std::uint64_t checksum{0};
+        NanoTimer timer;
+        timer.start();
+        for (size_t i{0}; i < OPS; ++i) {
+            checksum += point_set.get_points(point(generator), radius).size();
+        }
+        report("get_points", instance, OPS, timer.stop(), checksum);
+    }
+
+    {
+        constexpr size_t OPS{1 << 14};
+        const auto kswaps = make_kswaps(curve_tour, OPS);
+        std::uint64_t checksum{0};
+        NanoTimer timer;
+        timer.start();
+        for (const auto &kswap : kswaps) {
+            checksum += cycle_check::feasible(curve_tour, kswap);
+        }
+        report("feasible", instance, OPS, timer.stop(), checksum);
+    }
+
+    {
+        const size_t ops = std::max<size_t>(4, std::min<size_t>(1000, 100000000 / n));
+        auto tour = curve_tour;
+        const auto kswaps = make_kswaps(tour, ops);
+        double nanoseconds{0};
+        std::uint64_t checksum{0};
+        for (const auto &kswap : kswaps) {
+            NanoTimer timer;
+            timer.start();
+            tour.swap(kswap);
+            nanoseconds += timer.stop();
+            checksum += tour.length();
+            // every kswap is a move of the curve tour.
+            tour = curve_tour;
+        }
+        report("swap", instance, kswaps.size(), nanoseconds, checksum);
+    }
+
+    {
+        const size_t ops = std::max<size_t>(16, std::min<size_t>(2000, 20000000 / n));
+        auto tour = curve_tour;
+        HillClimber hill_climber(point_set);
+        double nanoseconds{0};
+        size_t calls{0};
+        while (calls < ops) {
+            NanoTimer timer;
+            timer.start();
+            const auto kmove = hill_climber.find_best(tour, KMAX);
+            nanoseconds += timer.stop();
+            ++calls;
+            if (not kmove) {
+                break;
+            }
+            tour.swap(*kmove);
+            hill_climber.changed(*kmove);
+        }
+        report("find_best", instance, calls, nanoseconds, tour.length());
+    }
+
+    {
+        constexpr size_t OPS{5};
+        constexpr size_t DIFFERING_EDGES{1000};
+        constexpr primitives::point_id_t SEGMENT{5};
+        const primitives::point_id_t spacing = std::max<primitives::point_id_t>(SEGMENT + 2, n / (DIFFERING_EDGES / 2));
+        auto reversed = order;
+        std::vector<primitives::point_id_t> touched;
+        for (primitives::point_id_t s{0}; s + SEGMENT + 1 < n; s += spacing) {
+            std::reverse(std::begin(reversed) + s + 1, std::begin(reversed) + s + SEGMENT + 1);
+            for (auto i : {s, s + 1, s + SEGMENT, s + SEGMENT + 1}) {
+                touched.push_back(order[i]);
+            }
+        }
+        const Tour current(&domain, reversed);
+        double nanoseconds{0};
+        std::uint64_t checksum{0};
+        for (size_t i{0}; i < OPS; ++i) {
+            auto merged = current;
+            NanoTimer timer;
+            timer.start();
+            merge::merge(merged, curve_tour, touched);
+            nanoseconds += timer.stop();
+            checksum = merged.length();
+        }
+        report("merge", instance, OPS, nanoseconds, checksum);
+    }
+
+    {
+        const auto path = (std::filesystem::temp_directory_path() / "kernels_bench.tsp").string();
+        bench::write_tsp(path, x, y);
+        // read_coordinates reports progress on std::cout.
+        cout_buffer = std::cout.rdbuf(discarded.rdbuf());
+        NanoTimer timer;
+        timer.start();
+        const auto [parsed_x, parsed_y] = fileio::read_coordinates(path);
+        const auto nanoseconds = timer.stop();
+        std::cout.rdbuf(cout_buffer);
+        std::remove(path.c_str());
+        std::uint64_t checksum{0};
+        for (primitives::point_id_t i{0}; i < parsed_x.size(); ++i) {
+            checksum += parsed_x[i] + parsed_y[i];
+        }
+        report("parse", instance, n, nanoseconds, checksum);
+    }
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+    const primitives::point_id_t max_points = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+    const std::string distribution_name = (argc > 2) ? argv[2] : "all";
+    std::vector<bench::Distribution> distributions;
+    if (distribution_name == "all") {
+        distributions = {bench::Distribution::uniform, bench::Distribution::clustered, bench::Distribution::vlsi};
+    } else {
+        distributions = {bench::parse_distribution(distribution_name)};
+    }
+    for (primitives::point_id_t n{10000}; n <= max_points; n *= 10) {
+        for (const auto distribution : distributions) {
+            auto [x, y] = bench::make_instance(distribution, n);
+            run({bench::name(distribution), std::move(x), std::move(y)});
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+// Compares kicks (see perturb.hh) in the k-opt iterated local search loop (kick, climb, merge):
+// acceptance rate (fraction of iterations that shortened the tour) and improvement per cpu second.
+// Every kick starts from the same locally optimal tour of a synthetic uniform instance.
+//
+// Usage: kicks.out [point_count] [cpu_seconds_per_kick] [kick_kmax]
+
+#include "bench/instances.hh"
+#include "hill_climb.hh"
+#include "hill_climber.hh"
+#include "merge/merge.hh"
+#include "perturb.hh"
+#include "point_quadtree/Domain.h"
+#include "point_quadtree/point_quadtree.h"
+#include "point_set.hh"
+#include "primitives.hh"
+#include "relabel.hh"
+#include "tour.hh"
+#include "two_short.hh"
+
+#include <ctime>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t KMAX{3};
+
+perturb::KickStats run(const HillClimber &initial_hill_climber
+    , const Tour &initial_tour
+    , double cpu_seconds
+    , const std::function<std::optional<KMove>(const Tour &)> &make_kick) {
+    auto hill_climber = initial_hill_climber;
+    auto tour = initial_tour;
+    perturb::KickStats stats;
+    auto current_length = tour.length();
+    // the climb and merge report progress on std::cout.
+    std::stringstream discarded;
+    auto *cout_buffer = std::cout.rdbuf(discarded.rdbuf());
+    while (stats.cpu_seconds < cpu_seconds) {
+        const auto cpu_start = std::clock();
+        const auto kick = make_kick(tour);
+        if (kick) {
+            auto hill_climber_copy = hill_climber;
+            auto new_tour = tour;
+            perturb::kick_in_place(hill_climber_copy, new_tour, KMAX, *kick);
+            const auto kmove = merge::merge(tour, new_tour);
+            if (kmove) {
+                hill_climber.changed(*kmove);
+                hill_climb::climb(hill_climber, tour, KMAX);
+            }
+        }
+        const auto new_length = tour.length();
+        stats.add(current_length, new_length, static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC);
+        current_length = new_length;
+        discarded.str("");
+    }
+    std::cout.rdbuf(cout_buffer);
+    return stats;
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+    const primitives::point_id_t n = (argc > 1) ? std::stoul(argv[1]) : 2000;
+    const double cpu_seconds = (argc > 2) ? std::stod(argv[2]) : 10;
+    const size_t kick_kmax = (argc > 3) ? std::stoul(argv[3]) : 4;
+    const auto [x, y] = bench::make_instance(bench::Distribution::uniform, n);
+    const point_quadtree::Domain domain(x, y);
+    const auto root = point_quadtree::make_quadtree(x, y, domain);
+    const PointSet point_set(root, x, y);
+    Tour tour(&domain, relabel::make_relabeling(x, y, relabel::Curve::hilbert).new_to_old);
+    HillClimber hill_climber(point_set);
+    hill_climb::hill_climb(hill_climber, tour, KMAX);
+
+    const primitives::length_t radius = 3 * tour.length() / tour.size();
+    const auto &short_edge_set = two_short::get_short_edges(point_set, tour);
+    const std::vector<edge::Edge> short_edges(std::cbegin(short_edge_set), std::cend(short_edge_set));
+    constexpr size_t WALK_STEP{10};
+
+    const std::vector<std::pair<std::string, std::function<std::optional<KMove>(const Tour &)>>> kicks{
+        {"kswap", [&](const Tour &t) -> std::optional<KMove> {
+            return perturb::kswap(t.order(), randomize::sequence(t.size()), kick_kmax); }},
+        {"local", [&](const Tour &t) {
+            return perturb::local_kswap(point_set, t, kick_kmax, radius); }},
+        {"walk", [&](const Tour &t) -> std::optional<KMove> {
+            return perturb::walk_kswap(t.order(), randomize::sequence(t.size()), kick_kmax, WALK_STEP); }},
+        {"close_pair", [&](const Tour &t) {
+            return perturb::close_pair_kswap(point_set, t, short_edges, kick_kmax, radius); }},
+    };
+    for (const auto &[name, make_kick] : kicks) {
+        const auto stats = run(hill_climber, tour, cpu_seconds, make_kick);
+        std::cout << "kick " << name
+            << " iterations " << stats.kicks
+            << " acceptance_rate " << stats.acceptance_rate()
+            << " improvement_per_cpu_second " << stats.improvement_per_cpu_second()
+            << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
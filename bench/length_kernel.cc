@@ -0,0 +1,64 @@
+// Checks that every supported length_kernel instruction set reproduces LengthCalculator exactly,
+// and reports throughput in distances per nanosecond for several candidate block sizes.
+
+#include "NanoTimer.h"
+#include "bench/instances.hh"
+#include "length_calculator.hh"
+#include "length_kernel.hh"
+#include "primitives.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main() {
+    constexpr primitives::point_id_t POINT_COUNT{1000000};
+    constexpr size_t TOTAL_DISTANCES{1 << 26};
+    const auto [x, y] = bench::make_instance(bench::Distribution::uniform, POINT_COUNT);
+    const LengthCalculator length_calculator(x, y);
+
+    std::vector<length_kernel::Isa> isas;
+    for (const auto isa : {length_kernel::Isa::scalar, length_kernel::Isa::avx2, length_kernel::Isa::avx512}) {
+        if (length_kernel::supported(isa)) {
+            isas.push_back(isa);
+        }
+    }
+
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<primitives::point_id_t> point(0, POINT_COUNT - 1);
+    for (const size_t block_size : {8, 32, 128, 1024}) {
+        std::vector<primitives::point_id_t> ids(block_size);
+        for (auto &id : ids) {
+            id = point(generator);
+        }
+        const auto a = point(generator);
+        std::vector<primitives::length_t> expected(block_size);
+        for (size_t i{0}; i < block_size; ++i) {
+            expected[i] = length_calculator(a, ids[i]);
+        }
+        for (const auto isa : isas) {
+            std::vector<primitives::length_t> lengths(block_size);
+            length_kernel::lengths(isa, x[a], y[a], x.data(), y.data(), 1, ids.data(), block_size, lengths.data());
+            if (lengths != expected) {
+                std::cout << length_kernel::name(isa) << ": error: lengths do not match scalar LengthCalculator.\n";
+                return EXIT_FAILURE;
+            }
+            const size_t repeats = TOTAL_DISTANCES / block_size;
+            primitives::length_t checksum{0};
+            NanoTimer timer;
+            timer.start();
+            for (size_t r{0}; r < repeats; ++r) {
+                length_kernel::lengths(isa, x[a], y[a], x.data(), y.data(), 1, ids.data(), block_size, lengths.data());
+                checksum += lengths[r % block_size];
+            }
+            const auto ns = timer.stop();
+            std::cout << "isa " << length_kernel::name(isa)
+                << " block_size " << block_size
+                << " distances_per_ns " << static_cast<double>(repeats * block_size) / ns
+                << " checksum " << checksum
+                << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
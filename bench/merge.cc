@@ -0,0 +1,83 @@
+// Measures merge::merge latency and heap allocations per merge against the number d of differing edges.
+// The current tour is a space-filling curve tour of a synthetic uniform instance with d / 2 short
+// segments reversed; the candidate is the unreversed tour, so that every reversal is an improving
+// exchange pair. The merge is given the touched points (see merge.hh), so its cost depends on d, not n.
+//
+// Usage: merge.out [point_count] [repetitions]
+
+#include "NanoTimer.h"
+#include "bench/instances.hh"
+#include "merge/merge.hh"
+#include "point_quadtree/Domain.h"
+#include "primitives.hh"
+#include "relabel.hh"
+#include "tour.hh"
+
+#include <algorithm> // reverse
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<size_t> allocations{0};
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+    ++allocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, const char **argv) {
+    const primitives::point_id_t n = (argc > 1) ? std::stoul(argv[1]) : 200000;
+    const size_t repetitions = (argc > 2) ? std::stoul(argv[2]) : 10;
+    const auto [x, y] = bench::make_instance(bench::Distribution::uniform, n);
+    const point_quadtree::Domain domain(x, y);
+    const auto order = relabel::make_relabeling(x, y, relabel::Curve::hilbert).new_to_old;
+    const Tour candidate(&domain, order);
+
+    constexpr primitives::point_id_t SEGMENT{5};
+    for (size_t d : {100, 1000, 10000}) {
+        // reverse order[s + 1, s + SEGMENT] at evenly spaced s: each reversal replaces 2 edges.
+        const primitives::point_id_t spacing = n / (d / 2);
+        auto reversed = order;
+        std::vector<primitives::point_id_t> touched;
+        for (primitives::point_id_t s{0}; s + SEGMENT + 1 < n; s += spacing) {
+            std::reverse(std::begin(reversed) + s + 1, std::begin(reversed) + s + SEGMENT + 1);
+            for (auto i : {s, s + 1, s + SEGMENT, s + SEGMENT + 1}) {
+                touched.push_back(order[i]);
+            }
+        }
+        const Tour current(&domain, reversed);
+
+        double seconds{0};
+        size_t allocation_count{0};
+        size_t applied_edges{0};
+        for (size_t r{0}; r < repetitions; ++r) {
+            auto merged = current;
+            NanoTimer timer;
+            const auto start_allocations = allocations.load();
+            timer.start();
+            const auto kmove = merge::merge(merged, candidate, touched);
+            seconds += timer.stop() / 1e9;
+            allocation_count += allocations.load() - start_allocations;
+            applied_edges = kmove ? kmove->removes.size() : 0;
+        }
+        std::cout << "differing_edges " << d
+            << " applied_edges " << applied_edges
+            << " ms_per_merge " << 1e3 * seconds / repetitions
+            << " allocations_per_merge " << allocation_count / repetitions
+            << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
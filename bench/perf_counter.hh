@@ -0,0 +1,64 @@
+#pragma once
+
+// Counts a hardware event (e.g. cache misses) for the calling thread via perf_event_open.
+// Hardware counters are often unavailable (virtual machines, containers, perf_event_paranoid),
+// in which case available() is false and read() returns nothing.
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+namespace bench {
+
+class PerfCounter {
+ public:
+    explicit PerfCounter(uint64_t config = PERF_COUNT_HW_CACHE_MISSES) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~PerfCounter() {
+        if (available()) {
+            close(fd_);
+        }
+    }
+    PerfCounter(const PerfCounter &) = delete;
+    PerfCounter &operator=(const PerfCounter &) = delete;
+
+    bool available() const { return fd_ >= 0; }
+
+    void start() {
+        if (available()) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    std::optional<uint64_t> stop() {
+        if (not available()) {
+            return std::nullopt;
+        }
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count{0};
+        if (::read(fd_, &count, sizeof(count)) != sizeof(count)) {
+            return std::nullopt;
+        }
+        return count;
+    }
+
+ private:
+    int fd_{-1};
+};
+
+}  // namespace bench
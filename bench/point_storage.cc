@@ -0,0 +1,63 @@
+// Runs the full hill climb with every coordinate storage policy (see point_storage.hh)
+// that the instance allows, and reports time and final tour length per policy.
+// Final lengths must agree, since every policy computes identical lengths.
+// The synthetic instance has integral coordinates, so that all policies are allowed,
+// and the initial tour follows a Hilbert curve, like the space-filling-curve tours the solver usually starts from.
+//
+// Usage: point_storage.out [point_count] [kmax]
+
+#include "NanoTimer.h"
+#include "bench/instances.hh"
+#include "hill_climb.hh"
+#include "point_quadtree/Domain.h"
+#include "point_quadtree/point_quadtree.h"
+#include "point_set.hh"
+#include "point_storage.hh"
+#include "primitives.hh"
+#include "relabel.hh"
+#include "tour.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename Storage>
+void climb(const std::vector<primitives::space_t> &x
+    , const std::vector<primitives::space_t> &y
+    , const std::vector<primitives::point_id_t> &initial_order
+    , size_t kmax) {
+    if (not Storage::allows(x, y)) {
+        std::cout << "storage " << Storage::NAME << " not allowed for this instance" << std::endl;
+        return;
+    }
+    const point_quadtree::Domain domain(x, y);
+    const auto root = point_quadtree::make_quadtree(x, y, domain);
+    const BasicPointSet<Storage> point_set(root, x, y);
+    Tour tour(&domain, initial_order);
+
+    NanoTimer timer;
+    timer.start();
+    const auto length = hill_climb::hill_climb(point_set, tour, kmax);
+    const auto ns = timer.stop();
+    std::cout << "storage " << Storage::NAME
+        << " seconds " << ns / 1e9
+        << " length " << length << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+    const primitives::point_id_t n = (argc > 1) ? std::stoul(argv[1]) : 20000;
+    const size_t kmax = (argc > 2) ? std::stoul(argv[2]) : 3;
+    const auto [x, y] = bench::make_instance(bench::Distribution::uniform, n);
+    const auto initial_order = relabel::make_relabeling(x, y, relabel::Curve::hilbert).new_to_old;
+
+    climb<point_storage::Soa>(x, y, initial_order, kmax);
+    climb<point_storage::Packed>(x, y, initial_order, kmax);
+    climb<point_storage::Float>(x, y, initial_order, kmax);
+    climb<point_storage::Quantized>(x, y, initial_order, kmax);
+    return EXIT_SUCCESS;
+}
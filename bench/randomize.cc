@@ -0,0 +1,116 @@
+// Compares the randomize module (per-thread xoshiro256**, Floyd's sampling) with what it replaced
+// (function-static std::mt19937, shuffling every candidate): generator throughput, and random_set
+// throughput for the kswap use case (k sequence ids out of n).
+// Also checks that random_set selects every element with probability k / n.
+
+#include "NanoTimer.h"
+#include "primitives.hh"
+#include "randomize/randomize.hh"
+#include "randomize/xoshiro.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace {
+
+// the previous randomize::random_set.
+std::vector<primitives::sequence_t> shuffled_set(std::mt19937 &generator
+    , primitives::sequence_t start
+    , primitives::sequence_t end
+    , size_t k) {
+    const auto &n = end - start;
+    std::vector<primitives::sequence_t> candidates(n);
+    for (primitives::sequence_t s{0}; s < n; ++s) {
+        candidates[s] = s;
+    }
+    const auto &begin = std::begin(candidates);
+    std::shuffle(begin, std::end(candidates), generator);
+    std::vector<primitives::sequence_t> selection(begin, begin + k);
+    std::sort(std::begin(selection), std::end(selection));
+    return selection;
+}
+
+template <typename Generator>
+void generator_throughput(const char *name, Generator &generator) {
+    constexpr size_t COUNT{1 << 27};
+    std::uint64_t checksum{0};
+    NanoTimer timer;
+    timer.start();
+    for (size_t i{0}; i < COUNT; ++i) {
+        checksum += generator();
+    }
+    const auto ns = timer.stop();
+    std::cout << "generator " << name
+        << " numbers_per_ns " << static_cast<double>(COUNT) / ns
+        << " checksum " << checksum
+        << std::endl;
+}
+
+template <typename Sampler>
+void set_throughput(const char *name, primitives::sequence_t n, size_t k, size_t samples, Sampler &&sampler) {
+    primitives::sequence_t checksum{0};
+    NanoTimer timer;
+    timer.start();
+    for (size_t i{0}; i < samples; ++i) {
+        checksum += sampler(n, k).back();
+    }
+    const auto ns = timer.stop();
+    std::cout << "random_set " << name
+        << " n " << n
+        << " k " << k
+        << " ns_per_set " << static_cast<double>(ns) / samples
+        << " checksum " << checksum
+        << std::endl;
+}
+
+}  // namespace
+
+int main() {
+    constexpr primitives::sequence_t UNIFORMITY_N{20};
+    constexpr size_t UNIFORMITY_K{5};
+    constexpr size_t UNIFORMITY_SAMPLES{1000000};
+    std::vector<size_t> counts(UNIFORMITY_N, 0);
+    for (size_t i{0}; i < UNIFORMITY_SAMPLES; ++i) {
+        const auto selection = randomize::random_set(0, UNIFORMITY_N, UNIFORMITY_K);
+        if (selection.size() != UNIFORMITY_K
+            or std::adjacent_find(std::cbegin(selection), std::cend(selection), std::greater_equal<>()) != std::cend(selection)) {
+            std::cout << "error: random_set did not return " << UNIFORMITY_K << " unique sorted ids." << std::endl;
+            return EXIT_FAILURE;
+        }
+        for (auto s : selection) {
+            ++counts[s];
+        }
+    }
+    const double expected = static_cast<double>(UNIFORMITY_SAMPLES) * UNIFORMITY_K / UNIFORMITY_N;
+    double max_relative_deviation{0};
+    for (auto c : counts) {
+        max_relative_deviation = std::max(max_relative_deviation, std::abs(c - expected) / expected);
+    }
+    std::cout << "random_set uniformity max_relative_deviation " << max_relative_deviation << std::endl;
+    if (max_relative_deviation > 0.01) {
+        std::cout << "error: random_set is not uniform." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937 mersenne_twister(0);
+    randomize::Xoshiro256ss xoshiro(0);
+    generator_throughput("mt19937", mersenne_twister);
+    generator_throughput("xoshiro256**", xoshiro);
+
+    for (const primitives::sequence_t n : {10000, 1000000, 10000000}) {
+        for (const size_t k : {4, 8}) {
+            const size_t floyd_samples{1000000};
+            set_throughput("floyd", n, k, floyd_samples, [](auto n, auto k) {
+                return randomize::random_set(0, n, k); });
+            const size_t shuffled_samples = std::max<size_t>(1, 100000000 / n);
+            set_throughput("shuffle", n, k, shuffled_samples, [&mersenne_twister](auto n, auto k) {
+                return shuffled_set(mersenne_twister, 0, n, k); });
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+// Compares the merge modes (see merge/recombine.hh): difference decomposition (dd) and partition crossover (gpx).
+// 1. In the k-opt loop (local kick, climb, merge) from the same locally optimal tour of a synthetic uniform
+//    instance: improvement per cpu second and mean merge latency.
+// 2. Recombining two locally optimal tours climbed from different initial tours (hilbert and morton order),
+//    which differ in many components: improvement and latency of a single merge.
+//
+// Usage: recombination.out [point_count] [cpu_seconds_per_mode] [kick_kmax] [dd_max_seconds]
+
+#include "NanoTimer.h"
+#include "bench/instances.hh"
+#include "hill_climb.hh"
+#include "hill_climber.hh"
+#include "merge/recombine.hh"
+#include "perturb.hh"
+#include "point_quadtree/Domain.h"
+#include "point_quadtree/point_quadtree.h"
+#include "point_set.hh"
+#include "primitives.hh"
+#include "relabel.hh"
+#include "tour.hh"
+
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility> // pair
+#include <vector>
+
+namespace {
+
+constexpr size_t KMAX{3};
+
+struct LoopStats {
+    perturb::KickStats kicks;
+    size_t merges{0};
+    double merge_seconds{0};
+};
+
+LoopStats run(merge::Mode mode
+    , const HillClimber &initial_hill_climber
+    , const Tour &initial_tour
+    , const PointSet &point_set
+    , double cpu_seconds
+    , size_t kick_kmax
+    , primitives::length_t radius) {
+    auto hill_climber = initial_hill_climber;
+    auto tour = initial_tour;
+    LoopStats stats;
+    auto current_length = tour.length();
+    // the climb and merge report progress on std::cout.
+    std::stringstream discarded;
+    auto *cout_buffer = std::cout.rdbuf(discarded.rdbuf());
+    while (stats.kicks.cpu_seconds < cpu_seconds) {
+        const auto cpu_start = std::clock();
+        const auto kick = perturb::local_kswap(point_set, tour, kick_kmax, radius);
+        if (kick) {
+            auto hill_climber_copy = hill_climber;
+            auto new_tour = tour;
+            perturb::kick_in_place(hill_climber_copy, new_tour, KMAX, *kick);
+            NanoTimer timer;
+            timer.start();
+            const auto kmove = merge::recombine(mode, tour, new_tour);
+            stats.merge_seconds += timer.stop() / 1e9;
+            ++stats.merges;
+            if (kmove) {
+                hill_climber.changed(*kmove);
+                hill_climb::climb(hill_climber, tour, KMAX);
+            }
+        }
+        const auto new_length = tour.length();
+        stats.kicks.add(current_length, new_length, static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC);
+        current_length = new_length;
+        discarded.str("");
+    }
+    std::cout.rdbuf(cout_buffer);
+    return stats;
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+    const primitives::point_id_t n = (argc > 1) ? std::stoul(argv[1]) : 5000;
+    const double cpu_seconds = (argc > 2) ? std::stod(argv[2]) : 10;
+    const size_t kick_kmax = (argc > 3) ? std::stoul(argv[3]) : 4;
+    const double dd_max_seconds = (argc > 4) ? std::stod(argv[4]) : 10;
+    const auto [x, y] = bench::make_instance(bench::Distribution::uniform, n);
+    const point_quadtree::Domain domain(x, y);
+    const auto root = point_quadtree::make_quadtree(x, y, domain);
+    const PointSet point_set(root, x, y);
+    const auto climbed = [&](relabel::Curve curve) {
+        std::pair<Tour, HillClimber> climbed{Tour(&domain, relabel::make_relabeling(x, y, curve).new_to_old), HillClimber(point_set)};
+        hill_climb::hill_climb(climbed.second, climbed.first, KMAX);
+        return climbed;
+    };
+    std::stringstream discarded;
+    auto *cout_buffer = std::cout.rdbuf(discarded.rdbuf());
+    const auto [tour, hill_climber] = climbed(relabel::Curve::hilbert);
+    const auto other = climbed(relabel::Curve::morton).first;
+    std::cout.rdbuf(cout_buffer);
+
+    const primitives::length_t radius = 3 * tour.length() / tour.size();
+    const std::vector<std::pair<std::string, merge::Mode>> modes{
+        {"dd", merge::Mode::difference_decomposition},
+        {"gpx", merge::Mode::partition_crossover},
+    };
+    for (const auto &[name, mode] : modes) {
+        const auto stats = run(mode, hill_climber, tour, point_set, cpu_seconds, kick_kmax, radius);
+        std::cout << "loop mode " << name
+            << " iterations " << stats.kicks.kicks
+            << " acceptance_rate " << stats.kicks.acceptance_rate()
+            << " improvement_per_cpu_second " << stats.kicks.improvement_per_cpu_second()
+            << " ms_per_merge " << 1e3 * stats.merge_seconds / stats.merges
+            << std::endl;
+    }
+
+    merge::CombinatorBudget budget;
+    budget.max_seconds = dd_max_seconds;
+    for (const auto &[name, mode] : modes) {
+        auto merged = tour;
+        std::cout.rdbuf(discarded.rdbuf());
+        NanoTimer timer;
+        timer.start();
+        merge::recombine(mode, merged, other, budget);
+        const auto seconds = timer.stop() / 1e9;
+        std::cout.rdbuf(cout_buffer);
+        std::cout << "recombine mode " << name
+            << " lengths " << tour.length() << " " << other.length()
+            << " merged_length " << merged.length()
+            << " ms " << 1e3 * seconds
+            << std::endl;
+    }
+    return EXIT_SUCCESS;
+}
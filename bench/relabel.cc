@@ -0,0 +1,89 @@
+// Measures neighborhood search throughput (and cache misses, if hardware counters are available)
+// with file-order point ids versus Morton- and Hilbert-relabeled ids.
+// The synthetic instance has points in random id order, like most TSPLIB files,
+// and the tour visits points along a Hilbert curve, like an optimized tour.
+//
+// Usage: relabel.out [point_count]
+
+#include "NanoTimer.h"
+#include "bench/instances.hh"
+#include "bench/perf_counter.hh"
+#include "point_quadtree/Domain.h"
+#include "point_quadtree/point_quadtree.h"
+#include "point_set.hh"
+#include "primitives.hh"
+#include "relabel.hh"
+#include "tour.hh"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void sweep(const std::string &label
+    , const std::vector<primitives::space_t> &x
+    , const std::vector<primitives::space_t> &y
+    , const std::vector<primitives::point_id_t> &tour_order
+    , primitives::length_t radius) {
+    const point_quadtree::Domain domain(x, y);
+    const auto root = point_quadtree::make_quadtree(x, y, domain);
+    const PointSet point_set(root, x, y);
+    const Tour tour(&domain, tour_order);
+
+    // visit every point in id order, as HillClimber::find_best does.
+    bench::PerfCounter cache_misses;
+    size_t candidates{0};
+    primitives::length_t checksum{0};
+    std::vector<primitives::length_t> lengths;
+    NanoTimer timer;
+    timer.start();
+    cache_misses.start();
+    for (primitives::point_id_t i{0}; i < point_set.size(); ++i) {
+        const auto points = point_set.get_points(i, radius);
+        point_set.lengths(i, points, lengths);
+        for (size_t c{0}; c < points.size(); ++c) {
+            const auto p = points[c];
+            checksum += lengths[c] + tour.next(p) + tour.prev(p);
+        }
+        candidates += points.size();
+    }
+    const auto misses = cache_misses.stop();
+    const auto ns = timer.stop();
+    std::cout << "order " << label
+        << " queries_per_us " << 1e3 * point_set.size() / ns
+        << " candidates_per_query " << static_cast<double>(candidates) / point_set.size()
+        << " cache_misses_per_query ";
+    if (misses) {
+        std::cout << static_cast<double>(*misses) / point_set.size();
+    } else {
+        std::cout << "unavailable";
+    }
+    std::cout << " checksum " << checksum << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+    const primitives::point_id_t n = (argc > 1) ? std::stoul(argv[1]) : 1000000;
+    const auto [x, y] = bench::make_instance(bench::Distribution::uniform, n);
+    // about 16 candidates per query.
+    const primitives::length_t radius = 2 * bench::SIDE / std::sqrt(n);
+
+    const auto hilbert = relabel::make_relabeling(x, y, relabel::Curve::hilbert);
+    const auto &tour_order = hilbert.new_to_old; // tour in original ids.
+    sweep("file", x, y, tour_order, radius);
+
+    for (const auto curve : {relabel::Curve::morton, relabel::Curve::hilbert}) {
+        const auto relabeling = relabel::make_relabeling(x, y, curve);
+        auto rx = x;
+        auto ry = y;
+        relabel::apply(relabeling, rx);
+        relabel::apply(relabeling, ry);
+        sweep(curve == relabel::Curve::morton ? "morton" : "hilbert"
+            , rx, ry, relabel::to_new(relabeling, tour_order), radius);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,307 @@
+// End-to-end solver benchmark: tour length as a function of time and thread count.
+// Runs the k-opt.cc pipeline (points relabeled along a space-filling curve and climbed from that order, then the
+// perturbation loop of driver.hh with the options of a k-opt config file) for a wall time budget, for each
+// instance, thread count and seed (1 to repeats); the initial climb always completes, even past the budget.
+// Like k-opt.cc, integral instances use the quantized point storage unless integral_coordinates is false.
+// The climbed tour and every improvement of the best length are samples
+// (elapsed_seconds, best_length, kicks), appended to the CSV file as they are taken; kicks only counts kicks
+// that produced a move (see driver::Hooks).
+// Per instance and thread count, the summary reports the mean final length and, relative to the shortest
+// final length of all runs of the instance (the reference):
+// - gap_auc: mean relative gap over the budget (the area under the gap curve divided by the budget),
+//   starting from the initial tour at time 0.
+// - ttt_<g>: mean time to reach a gap of g over the reached_<g> runs that reached it ("-" if none did).
+//
+// Instances: TSPLIB files, or synthetic instances as <distribution>:<points> (see instances.hh);
+// missing TSPLIB files are skipped, and without any instance the synthetic defaults are used, so that the
+// benchmark runs offline.
+//
+// Usage: solver.out [seconds_per_run] [repeats] [thread counts, e.g. 1,2,4] [csv_path] [config_path or -]
+//     [instances...]
+
+#include "bench/instances.hh"
+#include "config.hh"
+#include "driver.hh"
+#include "fileio.hh"
+#include "hill_climb.hh"
+#include "hill_climber.hh"
+#include "point_quadtree/Domain.h"
+#include "point_quadtree/point_quadtree.h"
+#include "point_set.hh"
+#include "point_storage.hh"
+#include "primitives.hh"
+#include "randomize/randomize.hh"
+#include "relabel.hh"
+#include "tour.hh"
+
+#include <algorithm> // min
+#include <chrono>
+#include <cmath> // llround
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility> // move
+#include <vector>
+
+namespace {
+
+const std::vector<double> TARGET_GAPS{0.05, 0.02, 0.01};
+const std::vector<std::string> DEFAULT_INSTANCES{"uniform:2000", "clustered:2000", "vlsi:2000"};
+
+struct Instance {
+    std::string name;
+    std::vector<primitives::space_t> x, y;
+    bool integral; // point_storage::Quantized::allows(x, y).
+};
+
+Instance to_instance(std::string name, std::vector<primitives::space_t> x, std::vector<primitives::space_t> y) {
+    const bool integral = point_storage::Quantized::allows(x, y);
+    return Instance{std::move(name), std::move(x), std::move(y), integral};
+}
+
+// The config file settings of the runs.
+struct Settings {
+    driver::Options options;
+    std::optional<relabel::Curve> relabel; // nothing: points keep their instance order.
+    bool integral_coordinates; // solve integral instances with the quantized storage.
+};
+
+// Discards all output, e.g. the progress reports of the solver on std::cout.
+class NullBuffer : public std::streambuf {
+ protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+};
+
+struct Sample {
+    double elapsed_seconds;
+    primitives::length_t best_length;
+    size_t kicks; // that produced a move, up to the sample (see driver::Hooks).
+};
+
+struct Run {
+    size_t instance;
+    size_t threads;
+    size_t seed;
+    primitives::length_t initial_length;
+    std::vector<Sample> samples;
+};
+
+std::optional<Instance> load(const std::string &spec) {
+    if (std::filesystem::exists(spec)) {
+        // read_coordinates reports progress on std::cout.
+        NullBuffer discarded;
+        auto *cout_buffer = std::cout.rdbuf(&discarded);
+        auto [x, y] = fileio::read_coordinates(spec);
+        std::cout.rdbuf(cout_buffer);
+        return to_instance(std::filesystem::path(spec).stem().string(), std::move(x), std::move(y));
+    }
+    const auto colon = spec.find(':');
+    if (colon == std::string::npos) {
+        std::cout << "skipping missing instance file: " << spec << std::endl;
+        return std::nullopt;
+    }
+    const auto distribution = bench::parse_distribution(spec.substr(0, colon));
+    auto [x, y] = bench::make_instance(distribution, std::stoul(spec.substr(colon + 1)));
+    return to_instance(spec, std::move(x), std::move(y));
+}
+
+// Writes every sample to csv as it is taken.
+template <typename Storage>
+Run solve(const Instance &instance, const Settings &settings, size_t threads, size_t seed, double seconds, std::ostream &csv) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto elapsed = [&start] { return std::chrono::duration<double>(Clock::now() - start).count(); };
+    randomize::seed(seed);
+    auto x = instance.x;
+    auto y = instance.y;
+    if (settings.relabel) {
+        const auto relabeling = relabel::make_relabeling(x, y, *settings.relabel);
+        relabel::apply(relabeling, x);
+        relabel::apply(relabeling, y);
+    }
+    const point_quadtree::Domain domain(x, y);
+    const auto root = point_quadtree::make_quadtree(x, y, domain);
+    const BasicPointSet<Storage> point_set(root, x, y);
+    Tour tour(&domain, fileio::default_tour(x.size()));
+    Run run{0, threads, seed, tour.length(), {}};
+    const auto add_sample = [&run, &csv, &instance](const Sample &sample) {
+        run.samples.push_back(sample);
+        csv << instance.name << ',' << run.threads << ',' << run.seed << ','
+            << sample.elapsed_seconds << ',' << sample.best_length << ',' << sample.kicks << '\n';
+    };
+
+    auto options = settings.options;
+    BasicHillClimber<BasicPointSet<Storage>> hill_climber(point_set);
+    hill_climb::hill_climb(hill_climber, tour, options.kmax);
+    add_sample({elapsed(), tour.length(), 0});
+    size_t kicks{0};
+    options.threads = threads;
+    driver::Hooks hooks;
+    hooks.improved = [&add_sample, &elapsed](const Tour &, primitives::length_t length, size_t iterations) {
+        add_sample({elapsed(), length, iterations});
+    };
+    hooks.stop = [&elapsed, &kicks, seconds](size_t iterations) {
+        kicks = iterations;
+        return elapsed() >= seconds;
+    };
+    driver::run(options, root, point_set, hill_climber, tour, hooks);
+    // final sample, so that the curve covers the whole budget.
+    add_sample({elapsed(), run.samples.back().best_length, kicks});
+    csv.flush();
+    return run;
+}
+
+// mean gap over [0, seconds] of the best length step function; the initial tour until the first sample.
+double gap_auc(const Run &run, primitives::length_t reference, double seconds) {
+    const auto gap = [reference](primitives::length_t length) { return static_cast<double>(length) / reference - 1; };
+    double area{0};
+    double t{0};
+    auto length = run.initial_length;
+    for (const auto &sample : run.samples) {
+        const auto end = std::min(sample.elapsed_seconds, seconds);
+        area += gap(length) * (end - t);
+        t = end;
+        length = sample.best_length;
+    }
+    area += gap(length) * (seconds - t);
+    return area / seconds;
+}
+
+std::optional<double> time_to_target(const Run &run, primitives::length_t reference, double target_gap) {
+    for (const auto &sample : run.samples) {
+        if (sample.best_length <= (1 + target_gap) * reference) {
+            return sample.elapsed_seconds;
+        }
+    }
+    return std::nullopt;
+}
+
+// Settings from the k-opt config file at path ("-" for none); without kick or kmax_kswap keys, runs use local
+// kicks of up to 5 edges, and without a relabel key, points are relabeled in hilbert order ("relabel none"
+// keeps the instance order). Island keys are ignored: runs are independent.
+Settings bench_settings(const std::string &path) {
+    const Config config(path == "-" ? "" : path);
+    Settings settings{driver::parse_options(config), relabel::Curve::hilbert, config.get("integral_coordinates", true)};
+    auto &options = settings.options;
+    if (not config.has("kick")) {
+        options.kick = "local";
+    }
+    if (not config.has("kmax_kswap")) {
+        options.kmax_kswap = 5;
+    }
+    options.island_name.reset();
+    if (const auto curve = config.get("relabel"); curve) {
+        settings.relabel.reset();
+        if (*curve != "none") {
+            settings.relabel = relabel::parse_curve(*curve);
+        }
+    }
+    return settings;
+}
+
+std::vector<size_t> parse_list(const std::string &list) {
+    std::vector<size_t> values;
+    std::stringstream stream(list);
+    std::string value;
+    while (std::getline(stream, value, ',')) {
+        values.push_back(std::stoul(value));
+    }
+    return values;
+}
+
+}  // namespace
+
+int main(int argc, const char **argv) {
+    const double seconds = (argc > 1) ? std::stod(argv[1]) : 10;
+    const size_t repeats = (argc > 2) ? std::stoul(argv[2]) : 3;
+    const auto thread_counts = parse_list((argc > 3) ? argv[3] : "1");
+    const std::string csv_path = (argc > 4) ? argv[4] : "solver_samples.csv";
+    const std::string config_path = (argc > 5) ? argv[5] : "-";
+    std::vector<Instance> instances;
+    for (int i{6}; i < argc; ++i) {
+        if (auto instance = load(argv[i]); instance) {
+            instances.push_back(std::move(*instance));
+        }
+    }
+    if (instances.empty()) {
+        for (const auto &spec : DEFAULT_INSTANCES) {
+            instances.push_back(*load(spec));
+        }
+    }
+
+    const auto settings = bench_settings(config_path);
+    std::ofstream csv(csv_path, std::ofstream::out);
+    csv << "instance,threads,seed,elapsed_seconds,best_length,kicks\n";
+
+    // the solver reports progress (e.g. quadtree stats) on std::cout.
+    NullBuffer discarded;
+    auto *cout_buffer = std::cout.rdbuf(&discarded);
+    std::vector<Run> runs;
+    for (size_t i{0}; i < instances.size(); ++i) {
+        const auto &instance = instances[i];
+        for (const auto threads : thread_counts) {
+            for (size_t seed{1}; seed <= repeats; ++seed) {
+                runs.push_back(instance.integral and settings.integral_coordinates
+                    ? solve<point_storage::Quantized>(instance, settings, threads, seed, seconds, csv)
+                    : solve<point_storage::Soa>(instance, settings, threads, seed, seconds, csv));
+                runs.back().instance = i;
+            }
+        }
+    }
+    std::cout.rdbuf(cout_buffer);
+    std::cout << "samples written to " << csv_path << std::endl;
+
+    for (size_t i{0}; i < instances.size(); ++i) {
+        auto reference = std::numeric_limits<primitives::length_t>::max();
+        for (const auto &run : runs) {
+            if (run.instance == i) {
+                reference = std::min(reference, run.samples.back().best_length);
+            }
+        }
+        for (const auto threads : thread_counts) {
+            double final_length{0};
+            double auc{0};
+            size_t run_count{0};
+            std::vector<double> ttt_sum(TARGET_GAPS.size(), 0);
+            std::vector<size_t> ttt_count(TARGET_GAPS.size(), 0);
+            for (const auto &run : runs) {
+                if (run.instance != i or run.threads != threads) {
+                    continue;
+                }
+                ++run_count;
+                final_length += run.samples.back().best_length;
+                auc += gap_auc(run, reference, seconds);
+                for (size_t g{0}; g < TARGET_GAPS.size(); ++g) {
+                    if (const auto t = time_to_target(run, reference, TARGET_GAPS[g]); t) {
+                        ttt_sum[g] += *t;
+                        ++ttt_count[g];
+                    }
+                }
+            }
+            std::cout << "instance " << instances[i].name
+                << " points " << instances[i].x.size()
+                << " threads " << threads
+                << " runs " << run_count
+                << " reference " << reference
+                << " mean_final_length " << std::llround(final_length / run_count)
+                << " gap_auc " << auc / run_count;
+            for (size_t g{0}; g < TARGET_GAPS.size(); ++g) {
+                std::cout << " ttt_" << TARGET_GAPS[g] << ' ';
+                if (ttt_count[g] > 0) {
+                    std::cout << ttt_sum[g] / ttt_count[g];
+                } else {
+                    std::cout << '-';
+                }
+                std::cout << " reached_" << TARGET_GAPS[g] << ' ' << ttt_count[g];
+            }
+            std::cout << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
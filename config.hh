@@ -12,6 +12,7 @@
 #include <fstream>
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <variant>
@@ -27,6 +28,9 @@ public:
     template <typename ValueType>
     ValueType get(const std::string& key, const ValueType& default_value) const;
 
+    // for values that may be written as integers or decimals (e.g. "10", "-1" or "0.5").
+    double get_number(const std::string& key, double default_value) const;
+
     bool has(const std::string& key) const;
 
 private:
@@ -113,6 +117,23 @@ ValueType Config::get(const std::string& key, const ValueType& default_value) co
     return default_value;
 }
 
+inline double Config::get_number(const std::string& key, double default_value) const {
+    if (not has(key)) {
+        return default_value;
+    }
+    const auto& value = m_dictionary.at(key);
+    if (const auto* unsigned_value = std::get_if<size_t>(&value)) {
+        return *unsigned_value;
+    }
+    if (const auto* signed_value = std::get_if<long>(&value)) {
+        return *signed_value;
+    }
+    if (const auto* double_value = std::get_if<double>(&value)) {
+        return *double_value;
+    }
+    throw std::invalid_argument(key + " must be a number.");
+}
+
 inline bool Config::has(const std::string& key) const {
     return m_dictionary.find(key) != std::cend(m_dictionary);
 }
@@ -0,0 +1,450 @@
+#pragma once
+
+// The perturbation loops of k-opt (partition, segment, parallel or single iterated local search), with their
+// options read from a Config (keys as in config.txt), so that k-opt and the solver benchmark run the same loop.
+// Progress is reported on std::cout, as in k-opt.
+
+#include "NanoTimer.h"
+#include "backbone.hh"
+#include "check.hh"
+#include "config.hh"
+#include "edge.hh"
+#include "hill_climb.hh"
+#include "hill_climber.hh"
+#include "ils.hh"
+#include "island.hh"
+#include "merge/recombine.hh"
+#include "merge/telemetry.hh"
+#include "parallel.hh"
+#include "partition.hh"
+#include "perturb.hh"
+#include "point_set.hh"
+#include "point_quadtree/node.hh"
+#include "pool.hh"
+#include "primitives.hh"
+#include "randomize/randomize.hh"
+#include "segment.hh"
+#include "tour.hh"
+#include "trace.hh"
+#include "trace_events.hh"
+#include "two_short.hh"
+
+#include <algorithm> // min
+#include <ctime> // clock
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace driver {
+
+struct Options {
+    size_t kmax{3};
+    size_t kmax_kswap{10};
+    // kick: "kswap" (random edges anywhere), or local kicks "local" (edges near a random point),
+    // "walk" (edges along a short random walk in the tour) or "close_pair" (seeded by short non-tour edges).
+    std::string kick{"kswap"};
+    size_t kick_walk_step{10};
+    size_t threads{1};
+    size_t sync_interval{5};
+    size_t partitions{0}; // 0: no partition mode.
+    size_t partition_kicks{10};
+    size_t segment_length{0}; // 0: no segment mode.
+    size_t segment_kicks{10};
+    merge::CombinatorBudget merge_budget;
+    std::string merge_mode{"dd"};
+    bool journaled{true};
+    std::optional<std::string> island_name; // no island mode if empty.
+    size_t island_id{0};
+    size_t island_count{2};
+    std::string island_topology{"ring"};
+    size_t migration_interval{20};
+    size_t pool_size{0}; // 0: no elite pool.
+    size_t pool_merges{3};
+    size_t pool_interval{50};
+    double pool_max_frozen{0.9};
+    size_t backbone{0}; // 0: no backbone.
+    size_t backbone_interval{10};
+    size_t telemetry_interval{100};
+};
+
+// Reads options from config; missing keys keep their defaults. Throws if an interval is 0.
+inline Options parse_options(const Config &config) {
+    Options options;
+    options.kmax = config.get("kmax", options.kmax);
+    options.kmax_kswap = config.get("kmax_kswap", options.kmax_kswap);
+    options.kick = config.get("kick", options.kick);
+    options.kick_walk_step = config.get("kick_walk_step", options.kick_walk_step);
+    options.threads = config.get("threads", options.threads);
+    options.sync_interval = config.get("sync_interval", options.sync_interval);
+    options.partitions = config.get("partitions", options.partitions);
+    options.partition_kicks = config.get("partition_kicks", options.partition_kicks);
+    options.segment_length = config.get("segment_length", options.segment_length);
+    options.segment_kicks = config.get("segment_kicks", options.segment_kicks);
+    options.merge_budget.threads = config.get<size_t>("merge_threads", 1);
+    options.merge_budget.max_nodes = config.get<size_t>("merge_max_nodes", 0);
+    options.merge_budget.max_seconds = config.get<size_t>("merge_max_milliseconds", 0) / 1e3;
+    options.merge_mode = config.get("merge_mode", options.merge_mode);
+    options.journaled = config.get("journal", options.journaled);
+    options.island_name = config.get("island_name");
+    options.island_id = config.get("island_id", options.island_id);
+    options.island_count = config.get("island_count", options.island_count);
+    options.island_topology = config.get("island_topology", options.island_topology);
+    options.migration_interval = config.get("migration_interval", options.migration_interval);
+    options.pool_size = config.get("pool_size", options.pool_size);
+    options.pool_merges = config.get("pool_merges", options.pool_merges);
+    options.pool_interval = config.get("pool_interval", options.pool_interval);
+    options.pool_max_frozen = config.get("pool_max_frozen", options.pool_max_frozen);
+    options.backbone = config.get("backbone", options.backbone);
+    options.backbone_interval = config.get("backbone_interval", options.backbone_interval);
+    options.telemetry_interval = config.get("telemetry_interval", options.telemetry_interval);
+    // intervals are used as divisors.
+    const auto check_interval = [](const std::string &key, size_t interval) {
+        if (interval == 0) {
+            throw std::invalid_argument(key + " must be positive");
+        }
+    };
+    check_interval("sync_interval", options.sync_interval);
+    check_interval("migration_interval", options.migration_interval);
+    check_interval("pool_interval", options.pool_interval);
+    check_interval("backbone_interval", options.backbone_interval);
+    check_interval("telemetry_interval", options.telemetry_interval);
+    return options;
+}
+
+// Callbacks of run; both are optional.
+struct Hooks {
+    // Called when the best length improves, with the best tour, its length and the iterations so far: kicks
+    // (that produced a move; of all workers in parallel mode), windows in segment mode or rounds in partition mode.
+    std::function<void(const Tour &, primitives::length_t, size_t)> improved;
+    // Checked before every iteration (round in parallel mode) with the iterations so far; run returns once it
+    // returns true.
+    std::function<bool(size_t)> stop;
+};
+
+// Runs the perturbation loop selected by options on tour, a local optimum of hill_climber (e.g. after
+// hill_climb::hill_climb), until hooks.stop returns true; tour is then the best tour found.
+// root is the quadtree of the tour's points (for close_pair kicks).
+template <typename Storage>
+void run(const Options &options
+    , const point_quadtree::Node &root
+    , const BasicPointSet<Storage> &point_set
+    , BasicHillClimber<BasicPointSet<Storage>> &hill_climber
+    , Tour &tour
+    , const Hooks &hooks = {})
+{
+    size_t iterations{0}; // see Hooks::improved.
+    const auto stop = [&hooks, &iterations] { return hooks.stop and hooks.stop(iterations); };
+    auto best_length = tour.length();
+    const auto record = [&hooks, &best_length, &iterations](const Tour &best_tour, primitives::length_t length) {
+        if (length < best_length) {
+            best_length = length;
+            if (hooks.improved) {
+                hooks.improved(best_tour, length, iterations);
+            }
+        }
+    };
+    const auto &kmax = options.kmax;
+    const auto &kmax_kswap = options.kmax_kswap;
+    const auto &threads = options.threads;
+    std::cout << "kmax_kswap: " << kmax_kswap << std::endl;
+
+    // partition mode: each round optimizes the tour as independent parts (sub-instances) in parallel.
+    if (options.partitions > 0) {
+        std::cout << "partitions: " << options.partitions
+            << ", partition_kicks: " << options.partition_kicks
+            << ", threads: " << threads << std::endl;
+        partition::Partitioner<Storage> partitioner(options.partitions, threads, kmax, kmax_kswap, options.partition_kicks);
+        NanoTimer partition_timer;
+        partition_timer.start();
+        while (not stop()) {
+            const auto kmoves = partitioner.round(tour);
+            ++iterations;
+            for (const auto &kmove : kmoves) {
+                hill_climber.changed(kmove);
+            }
+            // climbs across part boundaries.
+            primitives::length_t length;
+            {
+                TRACE_SCOPE("climb");
+                length = hill_climb::hill_climb(hill_climber, tour, kmax);
+            }
+            record(tour, length);
+            std::cout << "best length: " << best_length
+                << ", improved parts: " << kmoves.size()
+                << ", seconds: " << partition_timer.stop() / 1e9
+                << std::endl;
+        }
+        return;
+    }
+
+    // localized perturbation loop: each iteration kicks and climbs a window of consecutive points
+    // as a sub-instance, and only touches the full tour when the window improves.
+    if (options.segment_length > 0) {
+        std::cout << "segment_length: " << options.segment_length << ", segment_kicks: " << options.segment_kicks << std::endl;
+        auto &windows = iterations;
+        NanoTimer segment_timer;
+        segment_timer.start();
+        while (not stop()) {
+            const auto start = randomize::random_point(0, tour.size() - 1);
+            const auto kmove = segment::optimize<Storage>(tour, start, options.segment_length, kmax, kmax_kswap, options.segment_kicks);
+            ++windows;
+            if (kmove) {
+                tour.swap(*kmove);
+                hill_climber.changed(*kmove);
+                primitives::length_t length;
+                {
+                    TRACE_SCOPE("climb");
+                    length = hill_climb::hill_climb(hill_climber, tour, kmax);
+                }
+                record(tour, length);
+                std::cout << "best length: " << best_length
+                    << ", windows: " << windows
+                    << ", windows per second: " << windows / (segment_timer.stop() / 1e9)
+                    << std::endl;
+            }
+        }
+        return;
+    }
+    const auto &kick_type = options.kick;
+    std::cout << "kick: " << kick_type << std::endl;
+    const auto &kick_walk_step = options.kick_walk_step;
+    const primitives::length_t kick_radius = 3 * tour.length() / tour.size();
+    std::vector<edge::Edge> short_edges;
+    if (kick_type == "close_pair") {
+        const PointSet soa_point_set(root, tour.x(), tour.y());
+        const auto &short_edge_set = two_short::get_short_edges(soa_point_set, tour);
+        short_edges.assign(std::cbegin(short_edge_set), std::cend(short_edge_set));
+    }
+    auto make_kick = [&](const Tour &t) -> std::optional<KMove> {
+        TRACE_SCOPE("kick");
+        if (kick_type == "kswap") {
+            return perturb::kswap(t.order(), randomize::sequence(t.size()), kmax_kswap);
+        }
+        if (kick_type == "local") {
+            return perturb::local_kswap(point_set, t, kmax_kswap, kick_radius);
+        }
+        if (kick_type == "walk") {
+            return perturb::walk_kswap(t.order(), randomize::sequence(t.size()), kmax_kswap, kick_walk_step);
+        }
+        if (kick_type == "close_pair") {
+            return perturb::close_pair_kswap(point_set, t, short_edges, kmax_kswap, kick_radius);
+        }
+        throw std::invalid_argument("unrecognized kick: " + kick_type);
+    };
+    // limits on the search over combinations of exchange pairs in each merge.
+    const auto &merge_budget = options.merge_budget;
+    std::cout << "merge threads: " << merge_budget.threads
+        << ", max nodes: " << merge_budget.max_nodes
+        << ", max seconds: " << merge_budget.max_seconds << std::endl;
+    const auto merge_mode = merge::parse_mode(options.merge_mode);
+    std::cout << "merge mode: " << options.merge_mode << std::endl;
+
+    // journaled mode perturbs persistent working copies in place (see ils.hh).
+    const bool journaled = options.journaled;
+    std::cout << "journaled perturbation: " << journaled << std::endl;
+
+    // island mode: exchange best tours with other k-opt processes on this host through shared memory,
+    // every migration_interval kicks (rounds in parallel mode).
+    std::optional<island::Island> islands;
+    const auto &migration_interval = options.migration_interval;
+    size_t migrants{0};
+    size_t merged_migrants{0};
+    if (options.island_name) {
+        const auto topology = island::parse_topology(options.island_topology);
+        islands.emplace(*options.island_name, options.island_id, options.island_count, topology, tour.size());
+        std::cout << "island " << options.island_id << " of " << options.island_count
+            << ", migration_interval: " << migration_interval << std::endl;
+    }
+    // publishes best_tour, then merges migrants with merge_migrant (returns true if the migrant improved the tour).
+    auto migrate = [&](size_t iteration, const Tour &best_tour, auto merge_migrant) {
+        if (not islands or iteration % migration_interval != 0) {
+            return;
+        }
+        islands->publish(best_tour);
+        for (const auto &migrant : islands->receive(tour.domain())) {
+            ++migrants;
+            if (merge_migrant(migrant)) {
+                ++merged_migrants;
+            }
+        }
+        std::cout << "migrants received: " << migrants << ", improving migrants: " << merged_migrants << std::endl;
+    };
+
+    // elite pool: every pool_interval kicks (rounds in parallel mode), the current tours (and island migrants)
+    // are offered to a pool of pool_size local optima; when the pool changes, its pool_merges shortest members
+    // are merged into the best tour, and edges common to the full pool are frozen in the climbs, unless they
+    // exceed pool_max_frozen of all edges (members too similar, e.g. from a single search lineage).
+    std::optional<pool::TourPool> elite;
+    bool pool_changed{false};
+    const auto &pool_merges = options.pool_merges;
+    const auto &pool_interval = options.pool_interval;
+    const auto &pool_max_frozen = options.pool_max_frozen;
+    if (options.pool_size > 0) {
+        elite.emplace(tour.domain(), options.pool_size);
+        std::cout << "pool size: " << options.pool_size << ", pool_merges: " << pool_merges
+            << ", pool_interval: " << pool_interval << ", pool_max_frozen: " << pool_max_frozen << std::endl;
+    }
+    auto offer = [&elite, &pool_changed](const Tour &t) {
+        if (elite and elite->offer(t)) {
+            pool_changed = true;
+        }
+    };
+    // merge_member(tour) returns true if the member improved the best tour; freeze(edges) freezes edges.
+    auto update_pool = [&](size_t iteration, const std::vector<const Tour *> &tours, auto merge_member, auto freeze) {
+        if (not elite or iteration % pool_interval != 0) {
+            return;
+        }
+        for (const auto *t : tours) {
+            offer(*t);
+        }
+        if (not pool_changed) {
+            return;
+        }
+        pool_changed = false;
+        size_t improving{0};
+        for (size_t i{0}; i < std::min(pool_merges, elite->size()); ++i) {
+            if (merge_member(elite->tour(i))) {
+                ++improving;
+            }
+        }
+        auto common = elite->common_edges();
+        if (common.size() > pool_max_frozen * tour.size()) {
+            common.clear();
+        }
+        freeze(common);
+        std::cout << "pool members: " << elite->size() << ", shortest: " << elite->length(0)
+            << ", improving pool merges: " << improving << ", frozen edges: " << common.size() << std::endl;
+    };
+
+    // merge telemetry summary in the trace every telemetry_interval kicks (rounds in parallel mode).
+    const auto &telemetry_interval = options.telemetry_interval;
+    auto trace_telemetry = [&telemetry_interval](size_t iteration) {
+        if (iteration % telemetry_interval == 0) {
+            TRACE(info, "iteration " << iteration << ", " << merge::telemetry());
+        }
+    };
+
+    // parallel mode: worker threads with their own searches, merged into a global best every sync_interval kicks.
+    if (threads > 1) {
+        const auto &sync_interval = options.sync_interval;
+        std::cout << "threads: " << threads << ", sync_interval: " << sync_interval << std::endl;
+        parallel::Search<BasicPointSet<Storage>> search(hill_climber, tour, kmax, threads, merge_budget, merge_mode);
+        NanoTimer parallel_timer;
+        parallel_timer.start();
+        size_t rounds{0};
+        while (not stop()) {
+            bool improved = search.round(sync_interval, make_kick);
+            migrate(++rounds, search.best(), [&search, &improved, &offer](const Tour &migrant) {
+                offer(migrant);
+                const bool merged = search.import(migrant);
+                improved = improved or merged;
+                return merged;
+            });
+            std::vector<const Tour *> worker_tours;
+            for (size_t i{0}; i < search.workers(); ++i) {
+                worker_tours.push_back(&search.worker_tour(i));
+            }
+            update_pool(rounds, worker_tours, [&search, &improved](const Tour &member) {
+                const bool merged = search.import(member);
+                improved = improved or merged;
+                return merged;
+            }, [&search](const auto &edges) { search.freeze(edges); });
+            const auto stats = search.stats();
+            iterations = 0;
+            for (const auto &worker : stats) {
+                iterations += worker.iterations;
+            }
+            if (improved) {
+                record(search.best(), search.best().length());
+            }
+            std::cout << "best length: " << best_length
+                << ", seconds: " << parallel_timer.stop() / 1e9 << std::endl;
+            trace_telemetry(rounds);
+            for (size_t i{0}; i < stats.size(); ++i) {
+                std::cout << "thread " << i
+                    << " iterations: " << stats[i].iterations
+                    << ", iterations per second: " << stats[i].iterations_per_second()
+                    << ", merges into global best: " << stats[i].pushes
+                    << ", merges from global best: " << stats[i].pulls
+                    << std::endl;
+            }
+        }
+        tour = search.best();
+        return;
+    }
+
+    IteratedLocalSearch<BasicPointSet<Storage>> search(hill_climber, tour, kmax, journaled, merge_budget, merge_mode);
+    perturb::KickStats kick_stats;
+    auto current_length = tour.length();
+
+    // backbone: edges kept through backbone consecutive accepted local optima are frozen (refreshed every
+    // backbone_interval accepted local optima), together with the edges common to the elite pool.
+    std::optional<Backbone> backbone;
+    const auto &backbone_interval = options.backbone_interval;
+    if (options.backbone > 0) {
+        backbone.emplace(search.tour(), options.backbone);
+        std::cout << "backbone threshold: " << options.backbone
+            << ", backbone_interval: " << backbone_interval << std::endl;
+    }
+    std::vector<Backbone::Edge> pool_edges, backbone_edges;
+    size_t accepted{0};
+    const auto refreeze = [&search, &pool_edges, &backbone_edges]() {
+        auto edges = pool_edges;
+        edges.insert(std::cend(edges), std::cbegin(backbone_edges), std::cend(backbone_edges));
+        search.freeze(edges);
+    };
+    // the initial climb is the first local optimum; every kick that produces a move adds one.
+    size_t local_optima{1};
+    while (not stop()) {
+        const auto cpu_start = std::clock();
+        const auto kick = make_kick(search.tour());
+        if (not kick) {
+            continue;
+        }
+        ++iterations;
+        const auto kmove = search.step(*kick);
+        bool merged{false}; // true if a migrant or pool member changed the tour.
+        migrate(local_optima, search.tour(), [&search, &offer, &merged](const Tour &migrant) {
+            offer(migrant);
+            const bool improved = search.merge_from(migrant).has_value();
+            merged = merged or improved;
+            return improved;
+        });
+        update_pool(local_optima, {&search.tour()}, [&search, &merged](const Tour &member) {
+            const bool improved = search.merge_from(member).has_value();
+            merged = merged or improved;
+            return improved;
+        }, [&pool_edges, &refreeze](const auto &edges) {
+            pool_edges = edges;
+            refreeze();
+        });
+        if (backbone and (kmove or merged)) {
+            backbone->update(search.tour(), merged ? nullptr : search.changed_points());
+            if (++accepted % backbone_interval == 0) {
+                size_t frozen_points{0};
+                backbone_edges = backbone->edges(search.tour(), frozen_points);
+                refreeze();
+                std::cout << "backbone edges: " << backbone_edges.size()
+                    << ", frozen points: " << frozen_points
+                    << " (" << 100.0 * frozen_points / search.tour().size() << "%)" << std::endl;
+            }
+        }
+        check::check_tour(search.tour());
+        const auto new_length = search.tour().length();
+        kick_stats.add(current_length, new_length, static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC);
+        current_length = new_length;
+        record(search.tour(), new_length);
+        std::cout << "best length: " << best_length << std::endl;
+        ++local_optima;
+        std::cout << "local optima: " << local_optima << std::endl;
+        trace_telemetry(local_optima);
+        std::cout << "kick acceptance rate: " << kick_stats.acceptance_rate()
+            << ", improvement per cpu second: " << kick_stats.improvement_per_cpu_second() << std::endl;
+    }
+    tour = search.tour();
+}
+
+}  // namespace driver
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "primitives.hh"
+#include "relabel.hh"
 
 #include <array>
 #include <fstream>
@@ -25,6 +26,18 @@ inline void write_ordered_points(const std::vector<primitives::point_id_t>& orde
     }
 }
 
+// Writes points with their original (file) ids if points were relabeled.
+inline void write_ordered_points(const std::vector<primitives::point_id_t>& ordered_points
+    , const std::string output_filename
+    , const std::optional<relabel::Relabeling> &relabeling)
+{
+    if (relabeling) {
+        write_ordered_points(relabel::to_old(*relabeling, ordered_points), output_filename);
+    } else {
+        write_ordered_points(ordered_points, output_filename);
+    }
+}
+
 inline std::vector<primitives::point_id_t> read_ordered_points(const std::string &file_path)
 {
     std::cout << "\nReading tour file: " << file_path << std::endl;
@@ -87,6 +100,16 @@ inline std::vector<primitives::point_id_t> initial_tour(primitives::point_id_t p
     return tour_file_path ? read_ordered_points(*tour_file_path) : default_tour(point_count);
 }
 
+// Ids in the tour file are original (file) ids, and are mapped to new ids if points were relabeled.
+// The default tour follows original file order.
+inline std::vector<primitives::point_id_t> initial_tour(primitives::point_id_t point_count
+    , const std::optional<std::string> &tour_file_path
+    , const std::optional<relabel::Relabeling> &relabeling)
+{
+    const auto tour = initial_tour(point_count, tour_file_path);
+    return relabeling ? relabel::to_new(*relabeling, tour) : tour;
+}
+
 inline std::array<std::vector<primitives::space_t>, 2> read_coordinates(const std::string &file_path)
 {
     std::cout << "\nReading point set file: " << file_path << std::endl;
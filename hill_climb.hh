@@ -9,34 +9,33 @@
 
 namespace hill_climb {
 
-inline primitives::length_t hill_climb(const PointSet &point_set, Tour &tour, size_t kmax) {
-    HillClimber hill_climber(point_set);
+// Climbs without output; returns the number of improving moves.
+template <typename PointSetType>
+size_t climb(BasicHillClimber<PointSetType> &hill_climber, Tour &tour, size_t kmax) {
+    size_t iterations{0};
     auto kmove = hill_climber.find_best(tour, kmax);
-    int iterations{0};
     while (kmove) {
         tour.swap(*kmove);
         hill_climber.changed(*kmove);
         kmove = hill_climber.find_best(tour, kmax);
         ++iterations;
     }
-    const auto length = tour.length();
-    std::cout << "tour length after " << iterations << " iterations: " << length << std::endl;
-    return length;
+    return iterations;
 }
 
-inline primitives::length_t hill_climb(HillClimber &hill_climber, Tour &tour, size_t kmax) {
-    int iterations{0};
-    auto kmove = hill_climber.find_best(tour, kmax);
-    while (kmove) {
-        tour.swap(*kmove);
-        hill_climber.changed(*kmove);
-        kmove = hill_climber.find_best(tour, kmax);
-        ++iterations;
-    }
+template <typename PointSetType>
+primitives::length_t hill_climb(BasicHillClimber<PointSetType> &hill_climber, Tour &tour, size_t kmax) {
+    const auto iterations = climb(hill_climber, tour, kmax);
     const auto length = tour.length();
     std::cout << "tour length after " << iterations << " iterations: " << length << std::endl;
     return length;
 }
 
+template <typename PointSetType>
+primitives::length_t hill_climb(const PointSetType &point_set, Tour &tour, size_t kmax) {
+    BasicHillClimber<PointSetType> hill_climber(point_set);
+    return hill_climb(hill_climber, tour, kmax);
+}
+
 } // namespace hill_climb
 
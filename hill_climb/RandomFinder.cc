@@ -1,4 +1,5 @@
 #include "RandomFinder.h"
+#include "randomize/randomize.hh"
 
 namespace hill_climb {
 
@@ -32,7 +33,7 @@ RandomFinder::search_neighborhood(primitives::point_id_t p)
     {
         return filtered;
     }
-    std::random_shuffle(std::begin(filtered), std::end(filtered));
+    randomize::shuffle(std::begin(filtered), std::end(filtered));
     filtered.resize(samples);
     return filtered;
 }
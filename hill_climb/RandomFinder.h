@@ -3,7 +3,7 @@
 #include "GenericFinder.h"
 #include "primitives.hh"
 
-#include <algorithm> // max, random_shuffle
+#include <algorithm> // max
 #include <iostream>
 #include <vector>
 
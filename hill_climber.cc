@@ -1,7 +1,9 @@
 #include "hill_climber.hh"
+#include "metrics.hh"
 #include "multi_box.hh"
 
-void HillClimber::changed(const KMove &kmove) {
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::changed(const KMove &kmove) {
     MultiBox changed;
     for (size_t k{0}; k < kmove.starts.size(); ++k) {
         const auto &new_start = kmove.starts[k];
@@ -14,39 +16,114 @@ void HillClimber::changed(const KMove &kmove) {
             continue;
         }
         if (changed.touches(*search_extents_[i])) {
-            search_extents_[i] = std::nullopt;
+            metrics::count(metrics::Count::invalidations);
+            reset_extent(i, std::nullopt);
             continue;
         }
     }
 }
 
-void HillClimber::final_move_check() {
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::restore(const BasicHillClimber &original, const Journal &journal) {
+    if (search_extents_.size() != original.search_extents_.size()) {
+        search_extents_ = original.search_extents_;
+        return;
+    }
+    for (auto p : journal.points()) {
+        search_extents_[p] = original.search_extents_[p];
+    }
+}
+
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::fix_edge(primitives::point_id_t a, primitives::point_id_t b) {
+    if (m_fixed_edges.empty()) {
+        m_fixed_edges.resize(m_point_set.size(), {constants::invalid_point, constants::invalid_point});
+    }
+    for (auto [point, adjacent] : {std::array<primitives::point_id_t, 2>{a, b}, {b, a}}) {
+        auto &fixed = m_fixed_edges[point];
+        if (fixed[0] == constants::invalid_point) {
+            fixed[0] = adjacent;
+        } else if (fixed[1] == constants::invalid_point) {
+            fixed[1] = adjacent;
+        } else {
+            throw std::logic_error("more than 2 fixed edges at a point.");
+        }
+    }
+}
+
+template <typename PointSetType>
+bool BasicHillClimber<PointSetType>::fixed_edge(primitives::point_id_t a, primitives::point_id_t b) const {
+    if (m_fixed_edges.empty()) {
+        return false;
+    }
+    const auto &fixed = m_fixed_edges[a];
+    return fixed[0] == b or fixed[1] == b;
+}
+
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::unfix_edge(primitives::point_id_t a, primitives::point_id_t b) {
+    if (m_fixed_edges.empty()) {
+        return;
+    }
+    for (auto [point, adjacent] : {std::array<primitives::point_id_t, 2>{a, b}, {b, a}}) {
+        auto &fixed = m_fixed_edges[point];
+        if (fixed[0] == adjacent) {
+            fixed[0] = fixed[1];
+        } else if (fixed[1] != adjacent) {
+            throw std::logic_error("unfixed edge is not fixed.");
+        }
+        fixed[1] = constants::invalid_point;
+        if (not search_extents_.empty()) {
+            reset_extent(point, std::nullopt);
+        }
+    }
+}
+
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::reset_extent(primitives::point_id_t i, std::optional<Box> extent) {
+    if (m_journal) {
+        m_journal->record(i);
+    }
+    search_extents_[i] = extent;
+}
+
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::final_move_check() {
+    metrics::count(metrics::Count::feasibility_checks);
     if (cycle_check::feasible(*m_tour, m_kmove)) {
-        search_extents_[m_kmove.starts.front()] = std::nullopt;
+        reset_extent(m_kmove.starts.front(), std::nullopt);
         m_stop = true;
     }
 }
 
-bool HillClimber::final_new_edge() const {
+template <typename PointSetType>
+bool BasicHillClimber<PointSetType>::final_new_edge() const {
     return m_kmove.current_k() == m_kmax;
 }
 
-std::vector<primitives::point_id_t> HillClimber::search_neighborhood(primitives::point_id_t p) {
+template <typename PointSetType>
+std::vector<primitives::point_id_t> BasicHillClimber<PointSetType>::search_neighborhood(primitives::point_id_t p) {
     const auto search_radius = m_kmargin.total_margin + 1;
     const auto &box = m_point_set.get_box(p, search_radius);
     search_extents_[m_kmove.starts.front()]->include(box);
     return m_point_set.get_points(p, box);
 }
 
-std::optional<KMove> HillClimber::find_best(const Tour &tour, size_t kmax) {
+template <typename PointSetType>
+std::optional<KMove> BasicHillClimber<PointSetType>::find_best(const Tour &tour, size_t kmax) {
+    metrics::ScopedLatency latency(metrics::Latency::find_best);
     if (search_extents_.empty()) {
         search_extents_.resize(tour.size());
     }
     m_tour = &tour;
     m_kmax = kmax;
+    if (m_lengths.size() < kmax) {
+        m_lengths.resize(kmax);
+        m_squared_lengths.resize(kmax);
+    }
     reset_search();
     for (primitives::point_id_t i {0}; i < size(); ++i) {
-        if (search_extents_[i]) {
+        if (search_extents_[i] or frozen(i)) {
             continue;
         }
         search(i);
@@ -57,12 +134,16 @@ std::optional<KMove> HillClimber::find_best(const Tour &tour, size_t kmax) {
     return std::nullopt;
 }
 
-void HillClimber::search(primitives::point_id_t i) {
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::search(primitives::point_id_t i) {
     m_kmove.starts.push_back(i);
-    search_extents_[i] = std::make_optional<Box>();
+    reset_extent(i, std::make_optional<Box>());
     const std::array<primitives::point_id_t, 2> back_pair {prev(i), prev(i)};
     const std::array<primitives::point_id_t, 2> front_pair {i, next(i)};
     for(auto [edge, swap_end] : {back_pair, front_pair}) {
+        if (fixed(edge)) {
+            continue;
+        }
         m_kmove.removes.push_back(edge);
         m_kmargin.increase(length(edge));
         m_swap_end = swap_end;
@@ -76,10 +157,25 @@ void HillClimber::search(primitives::point_id_t i) {
     m_kmove.starts.pop_back();
 }
 
-void HillClimber::try_nearby_points() {
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::try_nearby_points() {
     const auto start = m_kmove.starts.back();
-    for (auto p : search_neighborhood(start))
+    const auto points = search_neighborhood(start);
+    metrics::count(metrics::Count::search_nodes);
+    metrics::count(metrics::Count::neighborhood_candidates, points.size());
+    constexpr bool INTEGRAL{PointSetType::StorageType::INTEGRAL};
+    const auto depth = m_kmove.current_k() - 1;
+    auto &lengths = m_lengths[depth];
+    auto &squared_lengths = m_squared_lengths[depth];
+    if constexpr (INTEGRAL) {
+        // lengths are only needed for candidates that pass the exact squared length test.
+        m_point_set.squared_lengths(start, points, squared_lengths);
+    } else {
+        m_point_set.lengths(start, points, lengths);
+    }
+    for (size_t c{0}; c < points.size(); ++c)
     {
+        const auto p = points[c];
         // check easy exclusion cases.
         const bool old_edge {p == next(start) or p == prev(start)};
         const bool self {p == start};
@@ -89,7 +185,16 @@ void HillClimber::try_nearby_points() {
         }
 
         // check if worth considering.
-        if (m_kmargin.decrease(length(start, p))) {
+        primitives::length_t candidate_length{0};
+        if constexpr (INTEGRAL) {
+            if (not m_kmargin.may_decrease(squared_lengths[c])) {
+                continue;
+            }
+            candidate_length = length(start, p);
+        } else {
+            candidate_length = lengths[c];
+        }
+        if (m_kmargin.decrease(candidate_length)) {
             if (m_kmove.endable(p)) {
                 m_kmove.ends.push_back(p);
                 // check if closing swap.
@@ -110,12 +215,13 @@ void HillClimber::try_nearby_points() {
     }
 }
 
-void HillClimber::delete_both_edges() {
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::delete_both_edges() {
     const auto i = m_kmove.ends.back();
     const std::array<primitives::point_id_t, 2> back_pair {prev(i), prev(i)};
     const std::array<primitives::point_id_t, 2> front_pair {i, next(i)};
     for(auto [edge, start] : {back_pair, front_pair}) {
-        if (not m_kmove.removable(edge) or not m_kmove.startable(start)) {
+        if (not m_kmove.removable(edge) or not m_kmove.startable(start) or fixed(edge)) {
             continue;
         }
         m_kmove.starts.push_back(start);
@@ -143,18 +249,25 @@ void HillClimber::delete_both_edges() {
     }
 }
 
-void HillClimber::reset_search() {
+template <typename PointSetType>
+void BasicHillClimber<PointSetType>::reset_search() {
     m_kmove.clear();
     m_kmargin.clear();
     m_swap_end = constants::invalid_point;
     m_stop = false;
 }
 
-primitives::length_t HillClimber::length(primitives::point_id_t a, primitives::point_id_t b) const {
+template <typename PointSetType>
+primitives::length_t BasicHillClimber<PointSetType>::length(primitives::point_id_t a, primitives::point_id_t b) const {
     return m_point_set.length(a, b);
 }
 
-primitives::length_t HillClimber::length(primitives::point_id_t edge_start) const {
+template <typename PointSetType>
+primitives::length_t BasicHillClimber<PointSetType>::length(primitives::point_id_t edge_start) const {
     return m_point_set.length(edge_start, next(edge_start));
 }
 
+template class BasicHillClimber<BasicPointSet<point_storage::Soa>>;
+template class BasicHillClimber<BasicPointSet<point_storage::Packed>>;
+template class BasicHillClimber<BasicPointSet<point_storage::Float>>;
+template class BasicHillClimber<BasicPointSet<point_storage::Quantized>>;
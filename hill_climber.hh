@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
 #include <optional>
 #include <vector>
 
+#include "journal.hh"
 #include "tour.hh"
 #include "primitives.hh"
 #include "point_set.hh"
@@ -10,15 +12,30 @@
 #include "kmargin.hh"
 #include "cycle_check.hh"
 
-class HillClimber
+// PointSetType is a BasicPointSet; see point_set.hh. Definitions are explicitly instantiated in
+// hill_climber.cc for every coordinate storage policy.
+template <typename PointSetType = PointSet>
+class BasicHillClimber
 {
  public:
-    HillClimber(const PointSet& point_set) : m_point_set(point_set) {}
+    BasicHillClimber(const PointSetType& point_set) : m_point_set(point_set) {}
 
     std::optional<KMove> find_best(const Tour &tour, size_t kmax);
 
     void changed(const KMove &kmove);
 
+    // Points whose search extents change are recorded in journal (nullptr to stop recording).
+    // Copies of the hill climber do not record (see JournalLink).
+    void set_journal(Journal *journal) { m_journal = journal; }
+    // Restores search extents of journaled points from original; see Tour::restore.
+    void restore(const BasicHillClimber &original, const Journal &journal);
+
+    // Fixed edges are never removed by a move (e.g. the closing edge of a segment sub-instance).
+    void fix_edge(primitives::point_id_t a, primitives::point_id_t b);
+    bool fixed_edge(primitives::point_id_t a, primitives::point_id_t b) const;
+    // Unfixes a fixed edge; its points are searched again.
+    void unfix_edge(primitives::point_id_t a, primitives::point_id_t b);
+
 private:
     size_t m_kmax {3};
 
@@ -43,7 +60,7 @@ private:
     std::vector<primitives::point_id_t> search_neighborhood(primitives::point_id_t p);
 
     const Tour *m_tour{nullptr};
-    const PointSet &m_point_set;
+    const PointSetType &m_point_set;
 
     primitives::sequence_t size() const {
         return m_tour->size();
@@ -56,5 +73,24 @@ private:
     }
 
     std::vector<std::optional<Box>> search_extents_;
+    // candidate (squared) lengths of try_nearby_points, one buffer per search depth since it recurses;
+    // reused by every search node.
+    std::vector<std::vector<primitives::length_t>> m_lengths;
+    std::vector<std::vector<primitives::squared_length_t>> m_squared_lengths;
+    JournalLink m_journal;
+    // up to 2 fixed adjacent points per point; empty if no edge is fixed.
+    std::vector<std::array<primitives::point_id_t, 2>> m_fixed_edges;
+
+    // true if edge (edge_start, next(edge_start)) is fixed.
+    bool fixed(primitives::point_id_t edge_start) const {
+        return not m_fixed_edges.empty() and fixed_edge(edge_start, next(edge_start));
+    }
+    // true if both edges of i are fixed, so that no search can start from i.
+    bool frozen(primitives::point_id_t i) const {
+        return not m_fixed_edges.empty() and fixed(i) and fixed(prev(i));
+    }
+
+    void reset_extent(primitives::point_id_t i, std::optional<Box> extent);
 };
 
+using HillClimber = BasicHillClimber<>;
@@ -0,0 +1,152 @@
+#pragma once
+
+// Iterated local search state: the current tour and its hill climber, plus a working copy of both that
+// each kick perturbs and climbs before the result is merged (merge::merge) into the current tour.
+// Journaled mode perturbs the working copies in place, and afterwards restores only the points that
+// changed in either the working copies or the current tour; otherwise the working copies are refreshed
+// by full copies of the current state.
+// The merge mode selects difference decomposition or partition crossover (see merge/recombine.hh).
+
+#include "hill_climb.hh"
+#include "hill_climber.hh"
+#include "journal.hh"
+#include "kmove.hh"
+#include "merge/recombine.hh"
+#include "perturb.hh"
+#include "primitives.hh"
+#include "tour.hh"
+#include "trace_events.hh"
+
+#include <algorithm> // max, min, remove_if, set_difference, sort, unique
+#include <iterator> // back_inserter
+#include <optional>
+#include <utility> // pair
+#include <vector>
+
+template <typename PointSetType>
+class IteratedLocalSearch {
+ public:
+    using Edge = std::pair<primitives::point_id_t, primitives::point_id_t>;
+
+    IteratedLocalSearch(const BasicHillClimber<PointSetType> &hill_climber
+        , const Tour &tour
+        , size_t kmax
+        , bool journaled
+        , const merge::CombinatorBudget &merge_budget = {}
+        , merge::Mode merge_mode = merge::Mode::difference_decomposition)
+        : kmax_(kmax)
+        , journaled_(journaled)
+        , merge_budget_(merge_budget)
+        , merge_mode_(merge_mode)
+        , tour_(tour)
+        , work_tour_(tour)
+        , hill_climber_(hill_climber)
+        , work_hill_climber_(hill_climber)
+        , journal_(tour.size())
+        , work_journal_(tour.size()) {
+        if (journaled_) {
+            tour_.set_journal(&journal_);
+            hill_climber_.set_journal(&journal_);
+            work_tour_.set_journal(&work_journal_);
+            work_hill_climber_.set_journal(&work_journal_);
+        }
+    }
+    // tours and hill climbers record into journals owned by this object.
+    IteratedLocalSearch(const IteratedLocalSearch &) = delete;
+    IteratedLocalSearch &operator=(const IteratedLocalSearch &) = delete;
+
+    const Tour &tour() const { return tour_; }
+
+    // Replaces the frozen edges, which climbs do not remove (e.g. edges common to a pool of elite tours);
+    // edges that are not in the current tour are ignored. Only edges that change are fixed or unfixed,
+    // so that the points of kept edges are not searched again.
+    void freeze(std::vector<Edge> edges) {
+        edges.erase(std::remove_if(std::begin(edges), std::end(edges), [this](const auto &edge) {
+            return tour_.next(edge.first) != edge.second and tour_.next(edge.second) != edge.first;
+        }), std::end(edges));
+        for (auto &edge : edges) {
+            edge = {std::min(edge.first, edge.second), std::max(edge.first, edge.second)};
+        }
+        std::sort(std::begin(edges), std::end(edges));
+        edges.erase(std::unique(std::begin(edges), std::end(edges)), std::end(edges));
+        std::vector<Edge> unfixed, fixed;
+        std::set_difference(std::cbegin(frozen_), std::cend(frozen_), std::cbegin(edges), std::cend(edges), std::back_inserter(unfixed));
+        std::set_difference(std::cbegin(edges), std::cend(edges), std::cbegin(frozen_), std::cend(frozen_), std::back_inserter(fixed));
+        for (auto *hill_climber : {&hill_climber_, &work_hill_climber_}) {
+            for (const auto &[a, b] : unfixed) {
+                hill_climber->unfix_edge(a, b);
+            }
+            for (const auto &[a, b] : fixed) {
+                hill_climber->fix_edge(a, b);
+            }
+        }
+        frozen_ = std::move(edges);
+        if (journaled_) {
+            sync_work_copy();
+        }
+    }
+    size_t frozen_edge_count() const { return frozen_.size(); }
+    // Points that the last step may have changed in the current tour (a superset); nullptr if unknown (not journaled).
+    const std::vector<primitives::point_id_t> *changed_points() const { return journaled_ ? &changed_points_ : nullptr; }
+
+    // Kicks and climbs the working copy, then merges it into the current tour and climbs.
+    // Returns the merging move, if the working copy improved part of the current tour.
+    std::optional<KMove> step(const KMove &kick) {
+        if (journaled_) {
+            perturb::kick_in_place(work_hill_climber_, work_tour_, kmax_, kick);
+        } else {
+            auto hill_climber_copy = hill_climber_;
+            work_tour_ = tour_;
+            perturb::kick_in_place(hill_climber_copy, work_tour_, kmax_, kick);
+        }
+        if (not journaled_) {
+            return merge(work_tour_);
+        }
+        // the working copy differs from the current tour only at journaled points.
+        const auto kmove = merge(work_tour_, &work_journal_.points());
+        changed_points_ = journal_.points();
+        sync_work_copy();
+        return kmove;
+    }
+
+    // Merges the candidate tour (e.g. the best tour of another search) into the current tour and climbs.
+    std::optional<KMove> merge_from(const Tour &candidate) {
+        const auto kmove = merge(candidate);
+        if (journaled_) {
+            sync_work_copy();
+        }
+        return kmove;
+    }
+
+ private:
+    const size_t kmax_;
+    const bool journaled_;
+    const merge::CombinatorBudget merge_budget_;
+    const merge::Mode merge_mode_;
+    Tour tour_;
+    Tour work_tour_;
+    BasicHillClimber<PointSetType> hill_climber_;
+    BasicHillClimber<PointSetType> work_hill_climber_;
+    Journal journal_;
+    Journal work_journal_;
+    std::vector<Edge> frozen_; // sorted (min, max) edges.
+    std::vector<primitives::point_id_t> changed_points_;
+
+    std::optional<KMove> merge(const Tour &candidate, const std::vector<primitives::point_id_t> *touched_points = nullptr) {
+        const auto kmove = merge::recombine(merge_mode_, tour_, candidate, merge_budget_, touched_points);
+        if (kmove) {
+            TRACE_SCOPE("climb");
+            hill_climber_.changed(*kmove);
+            hill_climb::climb(hill_climber_, tour_, kmax_);
+        }
+        return kmove;
+    }
+
+    void sync_work_copy() {
+        work_journal_.record(journal_);
+        work_tour_.restore(tour_, work_journal_);
+        work_hill_climber_.restore(hill_climber_, work_journal_);
+        journal_.clear();
+        work_journal_.clear();
+    }
+};
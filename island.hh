@@ -0,0 +1,252 @@
+#pragma once
+
+// Island model: several k-opt.out processes on one host (e.g. each started under numactl --cpunodebind)
+// exchange their best tours through POSIX shared memory, with no files or network involved.
+// Each island owns one shared memory slot ("/<name>_<island id>") holding its latest published tour,
+// guarded by a sequence counter (seqlock): odd while the owner writes, so readers never block the owner
+// and discard torn copies. Islands import the tours of their neighbors (per the topology) as migrants.
+// All islands must read the same instance with the same relabeling, so that point ids agree.
+// Slots of killed processes remain in /dev/shm until the next run with the same name replaces them.
+// Islands can start and restart in any order: a restarted island creates a new segment under its slot name,
+// which its neighbors detect (by inode) and open instead of the orphaned one.
+
+#include "point_quadtree/Domain.h"
+#include "primitives.hh"
+#include "tour.hh"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring> // memcpy, strerror
+#include <memory> // unique_ptr
+#include <new> // placement new
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h> // O_* constants
+#include <sys/mman.h>
+#include <sys/stat.h> // mode constants
+#include <unistd.h> // ftruncate, close
+
+namespace island {
+
+// ring: island i receives from island i - 1. complete: every island receives from every other island.
+enum class Topology { ring, complete };
+
+inline Topology parse_topology(const std::string &name) {
+    if (name == "ring") {
+        return Topology::ring;
+    }
+    if (name == "complete") {
+        return Topology::complete;
+    }
+    throw std::invalid_argument("unrecognized island topology: " + name);
+}
+
+// One island's published tour in shared memory.
+class Slot {
+ public:
+    // The owner creates the slot, replacing a slot left by a killed run; other islands open it once it exists.
+    static std::unique_ptr<Slot> create(const std::string &name, primitives::point_id_t point_count) {
+        // a new segment (O_EXCL), so that neighbors never see a stale one being resized.
+        shm_unlink(name.c_str());
+        const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+        if (fd < 0) {
+            throw std::runtime_error("could not create shared memory " + name + ": " + std::strerror(errno));
+        }
+        if (ftruncate(fd, bytes(point_count)) != 0) {
+            const auto error = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            throw std::runtime_error("could not size shared memory " + name + ": " + std::strerror(error));
+        }
+        return std::unique_ptr<Slot>(new Slot(name, point_count, true, fd, 0));
+    }
+    // returns nullptr if the slot does not exist yet or is not sized yet (its island has not started).
+    static std::unique_ptr<Slot> open(const std::string &name, primitives::point_id_t point_count) {
+        const int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat status;
+        if (fstat(fd, &status) != 0) {
+            const auto error = errno;
+            close(fd);
+            throw std::runtime_error("could not stat shared memory " + name + ": " + std::strerror(error));
+        }
+        // the owner creates the segment empty, then sizes it.
+        if (status.st_size == 0) {
+            close(fd);
+            return nullptr;
+        }
+        if (static_cast<size_t>(status.st_size) != bytes(point_count)) {
+            close(fd);
+            throw std::runtime_error("shared memory " + name + " does not match the instance size.");
+        }
+        return std::unique_ptr<Slot>(new Slot(name, point_count, false, fd, status.st_ino));
+    }
+
+    ~Slot() {
+        munmap(header_, bytes_);
+        if (owner_) {
+            shm_unlink(name_.c_str());
+        }
+    }
+    Slot(const Slot &) = delete;
+    Slot &operator=(const Slot &) = delete;
+
+    // true if the slot name no longer refers to this segment (its owner exited, or restarted and created a
+    // new segment); only for opened slots.
+    bool replaced() const {
+        const int fd = shm_open(name_.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            return true;
+        }
+        struct stat status;
+        const bool same = fstat(fd, &status) == 0 and status.st_ino == inode_;
+        close(fd);
+        return not same;
+    }
+
+    void write(const std::vector<primitives::point_id_t> &order) {
+        auto &sequence = header_->sequence;
+        sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(order_, order.data(), order.size() * sizeof(primitives::point_id_t));
+        sequence.fetch_add(1, std::memory_order_release);
+    }
+
+    // Copies the tour into order if it was published after last_sequence and not torn by a concurrent write.
+    // Returns the sequence of the copied tour, or last_sequence if nothing new was copied.
+    std::uint64_t read(std::uint64_t last_sequence, std::vector<primitives::point_id_t> &order) const {
+        const auto &sequence = header_->sequence;
+        const auto before = sequence.load(std::memory_order_acquire);
+        if (before == last_sequence or before % 2 == 1) {
+            return last_sequence;
+        }
+        order.resize(header_->point_count);
+        std::memcpy(order.data(), order_, order.size() * sizeof(primitives::point_id_t));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before) {
+            return last_sequence;
+        }
+        return before;
+    }
+
+ private:
+    struct Header {
+        std::atomic<std::uint64_t> sequence; // even: stable; odd: write in progress; 0: never written.
+        primitives::point_id_t point_count;
+    };
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "seqlock counter must be lock-free in shared memory.");
+
+    const std::string name_;
+    const bool owner_;
+    const ino_t inode_; // of the opened segment; 0 for the owner.
+    size_t bytes_{0};
+    Header *header_{nullptr};
+    primitives::point_id_t *order_{nullptr};
+
+    static size_t bytes(primitives::point_id_t point_count) {
+        return sizeof(Header) + point_count * sizeof(primitives::point_id_t);
+    }
+
+    // maps the sized segment of fd, and closes fd.
+    Slot(const std::string &name, primitives::point_id_t point_count, bool owner, int fd, ino_t inode)
+        : name_(name), owner_(owner), inode_(inode), bytes_(bytes(point_count)) {
+        void *address = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        const auto error = errno;
+        close(fd);
+        if (address == MAP_FAILED) {
+            if (owner) {
+                shm_unlink(name.c_str());
+            }
+            throw std::runtime_error("could not map shared memory " + name + ": " + std::strerror(error));
+        }
+        header_ = static_cast<Header *>(address);
+        order_ = reinterpret_cast<primitives::point_id_t *>(header_ + 1);
+        if (owner) {
+            new (header_) Header{{0}, point_count};
+        }
+    }
+};
+
+class Island {
+ public:
+    Island(const std::string &name, size_t id, size_t count, Topology topology, primitives::point_id_t point_count)
+        : name_(name)
+        , point_count_(point_count)
+        , own_(Slot::create(slot_name(id), point_count)) {
+        if (id >= count) {
+            throw std::invalid_argument("island id must be less than island count.");
+        }
+        for (size_t i{0}; i < count; ++i) {
+            const bool neighbor = i != id and (topology == Topology::complete or i == (id + count - 1) % count);
+            if (neighbor) {
+                neighbors_.push_back({i, nullptr, 0});
+            }
+        }
+    }
+
+    void publish(const Tour &tour) {
+        own_->write(tour.order());
+    }
+
+    // Tours published by neighbors since the last call.
+    std::vector<Tour> receive(const point_quadtree::Domain *domain) {
+        std::vector<Tour> migrants;
+        for (auto &neighbor : neighbors_) {
+            if (neighbor.slot and neighbor.slot->replaced()) {
+                // the neighbor restarted; its new slot starts over at sequence 0.
+                neighbor.slot.reset();
+                neighbor.last_sequence = 0;
+            }
+            if (not neighbor.slot) {
+                neighbor.slot = Slot::open(slot_name(neighbor.id), point_count_);
+                if (not neighbor.slot) {
+                    continue;
+                }
+            }
+            std::vector<primitives::point_id_t> order;
+            const auto sequence = neighbor.slot->read(neighbor.last_sequence, order);
+            if (sequence != neighbor.last_sequence) {
+                neighbor.last_sequence = sequence;
+                if (valid(order)) {
+                    migrants.emplace_back(domain, order);
+                }
+            }
+        }
+        return migrants;
+    }
+
+ private:
+    struct Neighbor {
+        size_t id;
+        std::unique_ptr<Slot> slot;
+        std::uint64_t last_sequence;
+    };
+    const std::string name_;
+    const primitives::point_id_t point_count_;
+    std::unique_ptr<Slot> own_;
+    std::vector<Neighbor> neighbors_;
+
+    std::string slot_name(size_t id) const { return "/" + name_ + "_" + std::to_string(id); }
+
+    // guards against slots left by a run on another instance.
+    bool valid(const std::vector<primitives::point_id_t> &order) const {
+        if (order.size() != point_count_) {
+            return false;
+        }
+        std::vector<bool> seen(point_count_, false);
+        for (auto p : order) {
+            if (p >= point_count_ or seen[p]) {
+                return false;
+            }
+            seen[p] = true;
+        }
+        return true;
+    }
+};
+
+}  // namespace island
@@ -0,0 +1,60 @@
+#pragma once
+
+// Records which points had per-point state (tour adjacency, hill climber search extents) modified since
+// the last clear(). A working copy of a Tour or HillClimber can then be brought back in line with its
+// original by restoring only the recorded points, instead of copying all n entries.
+
+#include "primitives.hh"
+
+#include <vector>
+
+class Journal {
+ public:
+    Journal() = default;
+    Journal(size_t point_count) : recorded_(point_count, false) {}
+
+    void record(primitives::point_id_t i) {
+        if (not recorded_[i]) {
+            recorded_[i] = true;
+            points_.push_back(i);
+        }
+    }
+    void record(const Journal &other) {
+        for (auto p : other.points_) {
+            record(p);
+        }
+    }
+
+    const auto &points() const { return points_; }
+    bool empty() const { return points_.empty(); }
+
+    void clear() {
+        for (auto p : points_) {
+            recorded_[p] = false;
+        }
+        points_.clear();
+    }
+
+ private:
+    std::vector<bool> recorded_;
+    std::vector<primitives::point_id_t> points_;
+};
+
+// The journal a Tour or HillClimber records into. It belongs to the owner of the object, not to its value:
+// a copy starts without a journal, and an assignment keeps the journal of the assigned object.
+class JournalLink {
+ public:
+    JournalLink() = default;
+    JournalLink(const JournalLink &) {}
+    JournalLink &operator=(const JournalLink &) { return *this; }
+    JournalLink &operator=(Journal *journal) {
+        journal_ = journal;
+        return *this;
+    }
+
+    explicit operator bool() const { return journal_ != nullptr; }
+    Journal *operator->() const { return journal_; }
+
+ private:
+    Journal *journal_{nullptr};
+};
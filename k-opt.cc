@@ -1,22 +1,100 @@
 #include "NanoTimer.h"
-#include "check.hh"
 #include "config.hh"
+#include "driver.hh"
+#include "edge.hh"
 #include "fileio.hh"
 #include "hill_climb.hh"
 #include "hill_climber.hh"
-#include "merge/merge.hh"
+#include "metrics.hh"
 #include "perturb.hh"
+#include "point_set.hh"
+#include "point_storage.hh"
 #include "point_quadtree/Domain.h"
 #include "point_quadtree/point_quadtree.h"
 #include "randomize/double_bridge.h"
+#include "randomize/randomize.hh"
+#include "relabel.hh"
 #include "tour.hh"
+#include "trace.hh"
+#include "trace_events.hh"
 #include "multicycle_tour.hh"
 #include "two_short.hh"
 
 #include <filesystem>
+#include <functional>
 #include <iostream>
 #include <optional>
 #include <string>
+#include <vector>
+
+namespace {
+
+// Climbs tour from the initial tour, then runs the configured perturbation loop (which does not return).
+// write_if_better(tour, length) saves tours shorter than best_length and updates it.
+template <typename Storage>
+void optimize(const driver::Options &options
+    , const point_quadtree::Node &root
+    , const std::vector<primitives::space_t> &x
+    , const std::vector<primitives::space_t> &y
+    , Tour &tour
+    , primitives::length_t &best_length
+    , const std::function<void(const Tour &, primitives::length_t)> &write_if_better)
+{
+    BasicPointSet<Storage> point_set(root, x, y);
+    std::cout << "point storage: " << Storage::NAME << std::endl;
+
+    // hill climb from initial tour.
+    BasicHillClimber<BasicPointSet<Storage>> hill_climber(point_set);
+    const auto &kmax = options.kmax;
+    std::cout << "kmax: " << kmax << std::endl;
+    auto new_length = [&] {
+        TRACE_SCOPE("initial climb");
+        return hill_climb::hill_climb(hill_climber, tour, kmax);
+    }();
+    if (new_length < best_length) {
+        best_length = new_length;
+        std::cout << "improvement: " << new_length << std::endl;
+    }
+    write_if_better(tour, new_length);
+
+    constexpr bool RUN_EXPERIMENTAL{false};
+    if (RUN_EXPERIMENTAL) {
+        // temporary experimental output.
+        const PointSet soa_point_set(root, x, y);
+        const auto &short_edge_set = two_short::get_short_edges(soa_point_set, tour);
+        std::vector<edge::Edge> short_edges(std::cbegin(short_edge_set), std::cend(short_edge_set));
+        fileio::write_pairs(short_edges, "output/short_edges.txt");
+        std::cout << "ratio of short edges to instance size: "
+            << static_cast<double>(short_edges.size()) / point_set.size()
+            << std::endl;
+        const auto &perturbation_kmove = two_short::make_perturbation(tour, short_edges);
+        std::cout << "replacement ratio: " << static_cast<double>(perturbation_kmove.current_k()) / point_set.size() << std::endl;
+
+        // temporary experimental output.
+        MulticycleTour mt(tour);
+        mt.multicycle_swap(perturbation_kmove);
+        std::cout << "post-swap cycle count: " << mt.cycles() << std::endl;
+        std::cout << "min cycle size: " << mt.min_cycle_size() << std::endl;
+        const auto &merging_kmove = perturb::random_cycle_merge_move(mt);
+        if (merging_kmove) {
+            mt.multicycle_swap(*merging_kmove);
+            std::cout << "cycles after merging move: " << mt.cycles() << std::endl;
+            fileio::write_ordered_points(mt.update_order(), "output/merged_tour.txt");
+            hill_climber.changed(*merging_kmove);
+            auto new_length = hill_climb::hill_climb(hill_climber, mt, kmax);
+            std::cout << "post-merge post-climb length: " << new_length << std::endl;
+        }
+    }
+
+    // perturbation loop.
+    driver::Hooks hooks;
+    hooks.improved = [&write_if_better](const Tour &best_tour, primitives::length_t length, size_t) {
+        write_if_better(best_tour, length);
+    };
+    driver::run(options, root, point_set, hill_climber, tour, hooks);
+}
+
+}  // namespace
 
 int main(int argc, const char** argv)
 {
@@ -27,6 +105,37 @@ int main(int argc, const char** argv)
     const std::string config_path = (argc == 1) ? "config.txt" : argv[1];
     std::cout << "Reading config file: " << config_path << std::endl;
     Config config(config_path);
+    // options of the perturbation loop (see driver.hh).
+    const auto options = driver::parse_options(config);
+
+    // Runs with the same seed (and thread count) are reproducible; the seed is printed either way.
+    const auto seed = config.get<size_t>("seed");
+    if (seed) {
+        randomize::seed(*seed);
+    }
+    std::cout << "random seed: " << randomize::current_seed() << std::endl;
+
+    // Merge diagnostics go to an opt-in trace file (see trace.hh) rather than the console.
+    const auto trace_level = trace::parse_level(config.get("trace_level", std::string("off")));
+    if (trace_level != trace::Level::off) {
+        const auto trace_file = config.get("trace_file", std::string("trace.txt"));
+        trace::open(trace_file, trace_level);
+        std::cout << "trace level: " << config.get("trace_level", std::string("off")) << ", trace_file: " << trace_file << std::endl;
+    }
+    // Solver metrics (see metrics.hh) appended as JSON lines to metrics_file every metrics_interval seconds.
+    std::optional<metrics::Reporter> metrics_reporter;
+    if (const auto metrics_file = config.get("metrics_file"); metrics_file) {
+        // Reporter rejects intervals that are not positive.
+        const auto metrics_interval = config.get_number("metrics_interval", 10);
+        metrics_reporter.emplace(*metrics_file, metrics_interval);
+        std::cout << "metrics_file: " << *metrics_file << ", metrics_interval: " << metrics_interval << std::endl;
+    }
+
+    // Phase timeline (see trace_events.hh), e.g. for ui.perfetto.dev.
+    if (const auto trace_events_file = config.get("trace_events_file"); trace_events_file) {
+        trace::open_events(*trace_events_file);
+        std::cout << "trace_events_file: " << *trace_events_file << std::endl;
+    }
 
     // Read input files.
     const std::optional<std::string> tsp_file_path_string = config.get("tsp_file_path");
@@ -35,8 +144,26 @@ int main(int argc, const char** argv)
         return EXIT_FAILURE;
     }
     const std::optional<std::filesystem::path> tsp_file_path(*tsp_file_path_string);
-    const auto [x, y] = fileio::read_coordinates(*tsp_file_path_string);
-    const auto initial_tour = fileio::initial_tour(x.size(), config.get("tour_file_path"));
+    auto [x, y] = [&tsp_file_path_string] {
+        TRACE_SCOPE("parse");
+        return fileio::read_coordinates(*tsp_file_path_string);
+    }();
+    // Integral instances use exact int32 coordinates, so that most candidates are rejected without sqrt.
+    const bool integral = point_storage::Quantized::allows(x, y) and config.get("integral_coordinates", true);
+    if (integral) {
+        std::cout << "All coordinates are integral (int32 coordinates are used)." << std::endl;
+    }
+
+    // Optionally relabel points along a space-filling curve ("morton" or "hilbert") for memory locality.
+    std::optional<relabel::Relabeling> relabeling;
+    const auto relabel_curve = config.get("relabel");
+    if (relabel_curve) {
+        std::cout << "Relabeling points in " << *relabel_curve << " order." << std::endl;
+        relabeling = relabel::make_relabeling(x, y, relabel::parse_curve(*relabel_curve));
+        relabel::apply(*relabeling, x);
+        relabel::apply(*relabeling, y);
+    }
+    const auto initial_tour = fileio::initial_tour(x.size(), config.get("tour_file_path"), relabeling);
 
     // Initial tour length calculation.
     point_quadtree::Domain domain(x, y);
@@ -54,7 +181,10 @@ int main(int argc, const char** argv)
     timer.start();
 
     std::cout << "\nquadtree stats:\n";
-    const auto root {point_quadtree::make_quadtree(x, y, domain)};
+    const auto root = [&] {
+        TRACE_SCOPE("quadtree");
+        return point_quadtree::make_quadtree(x, y, domain);
+    }();
     std::cout << "node ratio: "
         << static_cast<double>(point_quadtree::count_nodes(root))
             / point_quadtree::count_points(root)
@@ -72,79 +202,24 @@ int main(int argc, const char** argv)
             std::filesystem::create_directory(*save_dir);
         }
     }
-    auto write_if_better = [&](primitives::length_t new_length)
+    auto write_if_better = [&](const Tour &new_tour, primitives::length_t new_length)
     {
         if (new_length < best_length)
         {
             if (save_dir) {
+                TRACE_SCOPE("save");
                 const auto &save_path = *save_dir / (save_prefix + '_' + std::to_string(new_length) + ".tour");
-                fileio::write_ordered_points(tour.order(), save_path);
+                fileio::write_ordered_points(new_tour.order(), save_path, relabeling);
             }
             best_length = new_length;
         }
     };
 
-    PointSet point_set(root, x, y);
-
-    // hill climb from initial tour.
-    HillClimber hill_climber(point_set);
-    const auto &kmax = config.get<size_t>("kmax", 3);
-    std::cout << "kmax: " << kmax << std::endl;
-    auto new_length = hill_climb::hill_climb(hill_climber, tour, kmax);
-    if (new_length < best_length) {
-        best_length = new_length;
-        std::cout << "improvement: " << new_length << std::endl;
-    }
-    write_if_better(new_length);
-
-    constexpr bool RUN_EXPERIMENTAL{false};
-    if (RUN_EXPERIMENTAL) {
-        // temporary experimental output.
-        const auto &short_edge_set = two_short::get_short_edges(point_set, tour);
-        std::vector<edge::Edge> short_edges(std::cbegin(short_edge_set), std::cend(short_edge_set));
-        fileio::write_pairs(short_edges, "output/short_edges.txt");
-        std::cout << "ratio of short edges to instance size: "
-            << static_cast<double>(short_edges.size()) / point_set.size()
-            << std::endl;
-        const auto &perturbation_kmove = two_short::make_perturbation(tour, short_edges);
-        std::cout << "replacement ratio: " << static_cast<double>(perturbation_kmove.current_k()) / point_set.size() << std::endl;
-
-        // temporary experimental output.
-        MulticycleTour mt(tour);
-        mt.multicycle_swap(perturbation_kmove);
-        std::cout << "post-swap cycle count: " << mt.cycles() << std::endl;
-        std::cout << "min cycle size: " << mt.min_cycle_size() << std::endl;
-        const auto &merging_kmove = perturb::random_cycle_merge_move(mt);
-        if (merging_kmove) {
-            mt.multicycle_swap(*merging_kmove);
-            std::cout << "cycles after merging move: " << mt.cycles() << std::endl;
-            fileio::write_ordered_points(mt.update_order(), "output/merged_tour.txt");
-            hill_climber.changed(*merging_kmove);
-            auto new_length = hill_climb::hill_climb(hill_climber, mt, kmax);
-            std::cout << "post-merge post-climb length: " << new_length << std::endl;
-        }
+    if (integral) {
+        optimize<point_storage::Quantized>(options, root, x, y, tour, best_length, write_if_better);
+    } else {
+        optimize<point_storage::Soa>(options, root, x, y, tour, best_length, write_if_better);
     }
 
-    // perturbation loop.
-    size_t local_optima{1};
-    const auto &kmax_kswap = config.get<size_t>("kmax_kswap", 10);
-    std::cout << "kmax_kswap: " << kmax_kswap << std::endl;
-    do {
-        //const auto new_tour = perturb::perturb(hill_climber, tour, kmax);
-        //const auto new_tour = perturb::random_restart(point_set, &domain, kmax);
-        //const auto new_tour = perturb::random_section(hill_climber, tour, kmax, 0.05);
-        const auto new_tour = perturb::kswap(hill_climber, tour, kmax, kmax_kswap);
-        check::check_tour(new_tour);
-        const auto kmove = merge::merge(tour, new_tour);
-        if (kmove) {
-            hill_climber.changed(*kmove);
-            hill_climb::hill_climb(hill_climber, tour, kmax);
-        }
-        write_if_better(tour.length());
-        std::cout << "best length: " << best_length << std::endl;
-        ++local_optima;
-        std::cout << "local optima: " << local_optima << std::endl;
-    } while (true);
-
     return EXIT_SUCCESS;
 }
@@ -33,6 +33,14 @@ struct KMargin
         return true;
     }
 
+    // Exact test whether a candidate with the given squared length could pass decrease(),
+    // assuming its length is rounded as in LengthCalculator: round(sqrt(s)) < m if and only if s <= m * (m - 1).
+    // False means decrease() would certainly fail; true still requires decrease() on the rounded length.
+    bool may_decrease(primitives::squared_length_t squared_length) const
+    {
+        return total_margin > 0 and squared_length <= total_margin * (total_margin - 1);
+    }
+
     void pop_decrease()
     {
         total_margin += decreases.back();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "length_kernel.hh"
 #include "primitives.hh"
 
 #include <cmath>
@@ -14,6 +15,10 @@ public:
         : m_x(&x), m_y(&y) {}
 
     primitives::length_t operator()(primitives::point_id_t a, primitives::point_id_t b) const;
+    // lengths[i] = length from a to points[i]; uses the fastest available length_kernel.
+    void operator()(primitives::point_id_t a
+        , const std::vector<primitives::point_id_t>& points
+        , std::vector<primitives::length_t>& lengths) const;
 
     const auto& x() const { return *m_x; }
     const auto& y() const { return *m_y; }
@@ -37,3 +42,13 @@ inline primitives::length_t LengthCalculator::operator()(
     auto exact = std::sqrt(dx * dx + dy * dy);
     return exact + 0.5; // return type cast.
 }
+
+inline void LengthCalculator::operator()(primitives::point_id_t a
+    , const std::vector<primitives::point_id_t>& points
+    , std::vector<primitives::length_t>& lengths) const
+{
+    lengths.resize(points.size());
+    constexpr size_t stride {1};
+    length_kernel::lengths(x(a), y(a), m_x->data(), m_y->data(), stride
+        , points.data(), points.size(), lengths.data());
+}
@@ -0,0 +1,159 @@
+#include "length_kernel.hh"
+
+#include <immintrin.h>
+
+#include <cmath>
+
+namespace length_kernel {
+
+namespace {
+
+// Floating-point contraction (fused multiply-add) is disabled so that the vector paths
+// produce the same bits as the scalar expression in LengthCalculator.
+#define LENGTH_KERNEL_TARGET(isa) __attribute__((target(isa), optimize("fp-contract=off")))
+
+// Lengths are converted to integers in vector registers by truncating and then adding 2^52,
+// which places the integer in the low mantissa bits. This is exact for lengths below 2^52.
+constexpr double MANTISSA_SHIFT{4503599627370496.0}; // 2^52.
+
+inline primitives::length_t round_length(primitives::space_t dx, primitives::space_t dy) {
+    const auto exact = std::sqrt(dx * dx + dy * dy);
+    return exact + 0.5; // return type cast.
+}
+
+void scalar(primitives::space_t xa
+    , primitives::space_t ya
+    , const primitives::space_t *x
+    , const primitives::space_t *y
+    , size_t stride
+    , const primitives::point_id_t *ids
+    , size_t count
+    , primitives::length_t *out) {
+    for (size_t i{0}; i < count; ++i) {
+        const auto j = ids[i] * stride;
+        out[i] = round_length(xa - x[j], ya - y[j]);
+    }
+}
+
+LENGTH_KERNEL_TARGET("avx2")
+void avx2(primitives::space_t xa
+    , primitives::space_t ya
+    , const primitives::space_t *x
+    , const primitives::space_t *y
+    , size_t stride
+    , const primitives::point_id_t *ids
+    , size_t count
+    , primitives::length_t *out) {
+    constexpr size_t WIDTH{4};
+    const auto vxa = _mm256_set1_pd(xa);
+    const auto vya = _mm256_set1_pd(ya);
+    const auto half = _mm256_set1_pd(0.5);
+    const auto vstride = _mm_set1_epi32(static_cast<int>(stride));
+    // masked gathers with an explicit source avoid reading an uninitialized register.
+    const auto zero = _mm256_setzero_pd();
+    const auto all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    const auto shift = _mm256_set1_pd(MANTISSA_SHIFT);
+    size_t i{0};
+    for (; i + WIDTH <= count; i += WIDTH) {
+        auto index = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ids + i));
+        index = _mm_mullo_epi32(index, vstride);
+        const auto dx = _mm256_sub_pd(vxa, _mm256_mask_i32gather_pd(zero, x, index, all, sizeof(double)));
+        const auto dy = _mm256_sub_pd(vya, _mm256_mask_i32gather_pd(zero, y, index, all, sizeof(double)));
+        const auto squared = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+        const auto rounded = _mm256_round_pd(_mm256_add_pd(_mm256_sqrt_pd(squared), half), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const auto shifted = _mm256_castpd_si256(_mm256_add_pd(rounded, shift));
+        const auto integer = _mm256_sub_epi64(shifted, _mm256_castpd_si256(shift));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), integer);
+    }
+    scalar(xa, ya, x, y, stride, ids + i, count - i, out + i);
+}
+
+LENGTH_KERNEL_TARGET("avx512f")
+void avx512(primitives::space_t xa
+    , primitives::space_t ya
+    , const primitives::space_t *x
+    , const primitives::space_t *y
+    , size_t stride
+    , const primitives::point_id_t *ids
+    , size_t count
+    , primitives::length_t *out) {
+    constexpr size_t WIDTH{8};
+    const auto vxa = _mm512_set1_pd(xa);
+    const auto vya = _mm512_set1_pd(ya);
+    const auto half = _mm512_set1_pd(0.5);
+    const auto vstride = _mm256_set1_epi32(static_cast<int>(stride));
+    const auto zero = _mm512_setzero_pd();
+    constexpr __mmask8 ALL{0xff};
+    const auto shift = _mm512_set1_pd(MANTISSA_SHIFT);
+    size_t i{0};
+    for (; i + WIDTH <= count; i += WIDTH) {
+        auto index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ids + i));
+        index = _mm256_mullo_epi32(index, vstride);
+        const auto dx = _mm512_sub_pd(vxa, _mm512_mask_i32gather_pd(zero, ALL, index, x, sizeof(double)));
+        const auto dy = _mm512_sub_pd(vya, _mm512_mask_i32gather_pd(zero, ALL, index, y, sizeof(double)));
+        const auto squared = _mm512_add_pd(_mm512_mul_pd(dx, dx), _mm512_mul_pd(dy, dy));
+        const auto unrounded = _mm512_add_pd(_mm512_mask_sqrt_pd(zero, ALL, squared), half);
+        const auto rounded = _mm512_mask_roundscale_pd(zero, ALL, unrounded, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+        const auto shifted = _mm512_castpd_si512(_mm512_add_pd(rounded, shift));
+        const auto integer = _mm512_sub_epi64(shifted, _mm512_castpd_si512(shift));
+        _mm512_storeu_si512(out + i, integer);
+    }
+    avx2(xa, ya, x, y, stride, ids + i, count - i, out + i);
+}
+
+#undef LENGTH_KERNEL_TARGET
+
+}  // namespace
+
+bool supported(Isa isa) {
+    __builtin_cpu_init();
+    switch (isa) {
+        case Isa::avx512: return __builtin_cpu_supports("avx512f");
+        case Isa::avx2: return __builtin_cpu_supports("avx2");
+        default: return true;
+    }
+}
+
+Isa best_isa() {
+    // avx512 is not preferred because its gathers measured slower than avx2 (see bench/length_kernel.cc).
+    static const Isa isa = supported(Isa::avx2) ? Isa::avx2 : Isa::scalar;
+    return isa;
+}
+
+const char *name(Isa isa) {
+    switch (isa) {
+        case Isa::scalar: return "scalar";
+        case Isa::avx2: return "avx2";
+        case Isa::avx512: return "avx512";
+        default: return "unknown";
+    }
+}
+
+void lengths(Isa isa
+    , primitives::space_t xa
+    , primitives::space_t ya
+    , const primitives::space_t *x
+    , const primitives::space_t *y
+    , size_t stride
+    , const primitives::point_id_t *ids
+    , size_t count
+    , primitives::length_t *out) {
+    switch (isa) {
+        case Isa::avx512: avx512(xa, ya, x, y, stride, ids, count, out); return;
+        case Isa::avx2: avx2(xa, ya, x, y, stride, ids, count, out); return;
+        default: scalar(xa, ya, x, y, stride, ids, count, out); return;
+    }
+}
+
+void lengths(primitives::space_t xa
+    , primitives::space_t ya
+    , const primitives::space_t *x
+    , const primitives::space_t *y
+    , size_t stride
+    , const primitives::point_id_t *ids
+    , size_t count
+    , primitives::length_t *out) {
+    lengths(best_isa(), xa, ya, x, y, stride, ids, count, out);
+}
+
+}  // namespace length_kernel
@@ -0,0 +1,43 @@
+#pragma once
+
+// Batched rounded-length computation from one point to a block of candidate points.
+// Results are identical to LengthCalculator::operator() (sqrt of squared distance, plus 0.5, truncated).
+// Coordinates of candidate i are read from x[ids[i] * stride] and y[ids[i] * stride],
+// so that both separate (stride 1) and interleaved (stride 2) coordinate arrays can be used.
+
+#include "primitives.hh"
+
+#include <cstddef>
+
+namespace length_kernel {
+
+enum class Isa { scalar, avx2, avx512 };
+
+bool supported(Isa isa);
+
+// Fastest instruction set supported by the running cpu.
+Isa best_isa();
+
+const char *name(Isa isa);
+
+void lengths(Isa isa
+    , primitives::space_t xa
+    , primitives::space_t ya
+    , const primitives::space_t *x
+    , const primitives::space_t *y
+    , size_t stride
+    , const primitives::point_id_t *ids
+    , size_t count
+    , primitives::length_t *out);
+
+// Uses best_isa().
+void lengths(primitives::space_t xa
+    , primitives::space_t ya
+    , const primitives::space_t *x
+    , const primitives::space_t *y
+    , size_t stride
+    , const primitives::point_id_t *ids
+    , size_t count
+    , primitives::length_t *out);
+
+}  // namespace length_kernel
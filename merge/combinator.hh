@@ -1,63 +1,191 @@
 #pragma once
 
+#include <atomic>
+#include <limits>
+#include <mutex>
 #include <vector>
 #include <optional>
-#include <fstream>
+#include <sstream>
+#include <string>
 
+#include "combo_cycles.hh"
 #include "cycle_util.hh"
 #include "exchange_pair.hh"
+#include "telemetry.hh"
+#include <NanoTimer.h>
 #include <debug_util.hh>
 #include <multicycle_tour.hh>
+#include <thread_pool.hh>
+#include <trace.hh>
 
 namespace merge {
 
+// Limits on the (exponential) search over combinations of exchange pairs.
+// When a limit is reached, the best combination found so far is used.
+struct CombinatorBudget {
+    size_t threads{1}; // threads searching subtrees below the first levels of the include / exclude recursion.
+    size_t max_nodes{0}; // max combinations checked (0: no limit).
+    double max_seconds{0}; // max search time (0: no limit).
+};
+
 class Combinator {
  public:
     // Exchange pairs are sorted by improvement, highest to lowest.
-    Combinator(const std::vector<ExchangePair> &sorted_exchange_pairs, const Tour &best_tour, const Tour &candidate_tour)
-        : exchange_pairs_(sorted_exchange_pairs), best_tour_(best_tour), candidate_tour_(candidate_tour) {}
+    // With budget.threads > 1, subtrees are searched by the threads of pool (budget.threads of them).
+    Combinator(const std::vector<ExchangePair> &sorted_exchange_pairs
+        , const Tour &best_tour
+        , const Tour &candidate_tour
+        , const CombinatorBudget &budget = {}
+        , parallel::ThreadPool *pool = nullptr)
+        : exchange_pairs_(sorted_exchange_pairs)
+        , best_tour_(best_tour)
+        , candidate_tour_(candidate_tour)
+        , budget_(budget)
+        , pool_(pool)
+        , max_gain_(sorted_exchange_pairs.size() + 1, 0)
+        , cycles_(best_tour, candidate_tour, sorted_exchange_pairs) {
+        // max_gain_[i]: largest improvement that pairs i and later can add to a combination.
+        for (size_t i{exchange_pairs_.size()}; i > 0; --i) {
+            max_gain_[i - 1] = max_gain_[i] + std::max(*exchange_pairs_[i - 1].improvement, 0);
+        }
+    }
 
-    void find(size_t i = 0) {
-        if (i == exchange_pairs_.size()) {
+    // The result does not depend on the thread count: among equally improving combinations,
+    // the first in (serial) search order is kept. With a node or time budget, it may.
+    void find() {
+        timer_.start();
+        if (budget_.threads <= 1) {
+            State state{{}, 0, cycles_};
+            find(state, 0);
             return;
         }
-        const auto improvement = *exchange_pairs_[i].improvement;
-        if (margin_ + improvement <= 0) {
-            return;
+        if (not pool_ or pool_->size() != budget_.threads) {
+            throw std::logic_error("parallel combinator search needs a pool of budget.threads threads.");
+        }
+        // split the first levels of the recursion into tasks, which threads take in order.
+        size_t depth{0};
+        while (depth < exchange_pairs_.size() and (size_t{1} << depth) < 8 * budget_.threads) {
+            ++depth;
         }
-        combo_.push_back(i);
-        margin_ += improvement;
-        check_combo();
-        find(i + 1); // try with this.
-        combo_.pop_back();
-        margin_ -= improvement;
-        find(i + 1); // try without this.
+        std::vector<Task> tasks;
+        State state{{}, 0, cycles_};
+        make_tasks(state, 0, depth, tasks);
+        std::atomic<size_t> next_task{0};
+        pool_->run([this, &tasks, &next_task](size_t) {
+            for (auto i = next_task++; i < tasks.size(); i = next_task++) {
+                find(tasks[i].state, tasks[i].next);
+            }
+        });
     }
 
     size_t viable_count() const { return viable_count_; }
     const auto &best_combo() const { return best_combo_; }
     const auto &best_improvement() const { return best_improvement_; }
-    const auto &checks() const { return checks_; }
+    size_t checks() const { return checks_; }
+    // true if the search stopped early because of the budget.
+    bool exhausted() const { return stop_; }
 
  private:
+    using Combo = std::vector<size_t>;
+    // state of one depth-first search.
+    struct State {
+        Combo combo;
+        int margin{0};
+        ComboCycles cycles; // cycle structure of combo.
+    };
+    struct Task {
+        State state;
+        size_t next; // next exchange pair to include or exclude.
+    };
+
     const std::vector<ExchangePair> &exchange_pairs_;
     const Tour &best_tour_;
     const Tour &candidate_tour_;
+    const CombinatorBudget budget_;
+    parallel::ThreadPool *const pool_;
+    std::vector<int> max_gain_;
+    const ComboCycles cycles_; // no pairs pushed; copied into each search state.
 
-    using Combo = std::vector<size_t>;
-    Combo combo_;
+    std::mutex best_mutex_;
     std::optional<int> best_improvement_;
     std::optional<Combo> best_combo_;
-    int margin_{0};
-    size_t viable_count_{0};
-    size_t checks_{0};
-
-    void check_combo() {
-        ++checks_;
-        const auto breaks_cycle = cycle_util::breaks_cycle(best_tour_, candidate_tour_, exchange_pairs_, combo_);
-        if (breaks_cycle) {
-            if (cycle_util::count_cycles(best_tour_, candidate_tour_, exchange_pairs_, combo_) == 2) {
-                std::cout << "found double cycle tour with margin " << margin_ << std::endl;
+    // copy of best_improvement_ for pruning without locking.
+    std::atomic<int> best_bound_{std::numeric_limits<int>::min()};
+    std::atomic<size_t> viable_count_{0};
+    std::atomic<size_t> checks_{0};
+    std::atomic<bool> stop_{false};
+    NanoTimer timer_;
+
+    // Returns false if the subtree of exchange pair i cannot contain a combination
+    // at least as good as the best so far.
+    bool promising(const State &state, size_t i) const {
+        if (stop_ or i == exchange_pairs_.size()) {
+            return false;
+        }
+        if (state.margin + *exchange_pairs_[i].improvement <= 0) {
+            return false;
+        }
+        // equal improvements are not pruned, so that ties resolve the same for any thread count.
+        return state.margin + max_gain_[i] >= best_bound_.load(std::memory_order_relaxed);
+    }
+
+    void find(State &state, size_t i) {
+        if (not promising(state, i)) {
+            return;
+        }
+        const auto improvement = *exchange_pairs_[i].improvement;
+        state.combo.push_back(i);
+        state.margin += improvement;
+        state.cycles.push(i);
+        check_combo(state);
+        find(state, i + 1); // try with this.
+        state.combo.pop_back();
+        state.margin -= improvement;
+        state.cycles.pop(i);
+        find(state, i + 1); // try without this.
+    }
+
+    void make_tasks(State &state, size_t i, size_t depth, std::vector<Task> &tasks) {
+        if (i == depth) {
+            tasks.push_back({state, i});
+            return;
+        }
+        if (not promising(state, i)) {
+            return;
+        }
+        const auto improvement = *exchange_pairs_[i].improvement;
+        state.combo.push_back(i);
+        state.margin += improvement;
+        state.cycles.push(i);
+        check_combo(state);
+        make_tasks(state, i + 1, depth, tasks);
+        state.combo.pop_back();
+        state.margin -= improvement;
+        state.cycles.pop(i);
+        make_tasks(state, i + 1, depth, tasks);
+    }
+
+    void check_budget(size_t checks) {
+        if (budget_.max_nodes > 0 and checks >= budget_.max_nodes) {
+            stop_ = true;
+        }
+        constexpr size_t TIME_CHECK_INTERVAL{256};
+        if (budget_.max_seconds > 0 and checks % TIME_CHECK_INTERVAL == 0 and timer_.stop() / 1e9 > budget_.max_seconds) {
+            stop_ = true;
+        }
+    }
+
+    void check_combo(State &state) {
+        check_budget(++checks_);
+        const auto &combo_ = state.combo;
+        const auto &margin_ = state.margin;
+        const auto cycle_count = state.cycles.count_cycles();
+        if (cycle_count != 1) {
+            if (cycle_count == 2) {
+                telemetry().double_cycles.add();
+            }
+            if (cycle_count == 2 and trace::enabled(trace::Level::verbose)) {
+                TRACE(verbose, "found double cycle tour with margin " << margin_);
                 // perform swap, output cycles for plotting.
                 const auto &kmove = cycle_util::to_kmove(best_tour_, candidate_tour_, exchange_pairs_, combo_);
                 MulticycleTour test_tour = best_tour_;
@@ -67,15 +195,16 @@ class Combinator {
                     throw std::logic_error("unexpected cycle count.");
                 }
                 if (0.05 < std::min(cycles[0].size(), cycles[1].size()) / static_cast<double>(test_tour.size())) {
-                    std::cout << "writing out cycles for plotting.\n";
+                    TRACE(verbose, "writing out cycles for plotting.");
                     primitives::cycle_id_t cycle_id{0};
                     for (const auto &cycle : cycles) {
-                        std::ofstream cycle_file("output/cycle" + std::to_string(cycle_id) + "_margin_" + std::to_string(margin_) + ".txt", std::ofstream::out);
+                        std::ostringstream cycle_edges;
                         primitives::point_id_t prev{cycle.back()};
                         for (const auto &i : cycle) {
-                            cycle_file << prev << ' ' << i << std::endl;
+                            cycle_edges << prev << ' ' << i << '\n';
                             prev = i;
                         }
+                        trace::dump("output/cycle" + std::to_string(cycle_id) + "_margin_" + std::to_string(margin_) + ".txt", cycle_edges.str());
                         ++cycle_id;
                     }
                 }
@@ -83,14 +212,22 @@ class Combinator {
             return;
         }
         ++viable_count_;
-        if (not best_improvement_ or margin_ > *best_improvement_) {
+        if (margin_ < best_bound_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(best_mutex_);
+        if (not best_improvement_ or margin_ > *best_improvement_
+            or (margin_ == *best_improvement_ and combo_ < *best_combo_)) {
             best_combo_ = std::make_optional<Combo>(combo_);
             best_improvement_ = std::make_optional(margin_);
-            std::cout << "better combo: ";
-            for (const auto &i : *best_combo_) {
-                std::cout << i << " ";
+            best_bound_ = margin_;
+            if (trace::enabled(trace::Level::verbose)) {
+                std::ostringstream combo;
+                for (const auto &i : *best_combo_) {
+                    combo << i << " ";
+                }
+                TRACE(verbose, "better combo: " << combo.str());
             }
-            std::cout << std::endl;
         }
     }
 };
@@ -0,0 +1,259 @@
+#pragma once
+
+// Cycle structure of combinations of exchange pairs, for the Combinator search.
+// Each exchange pair is precompiled once into its removed edges (as positions in the current tour's
+// sequence order) and its new edges (over compact ids of the points involved). Pushing or popping a
+// pair then costs O(edges in the pair), and counting the cycles of the combined move traverses the
+// removed edges of the combination with array lookups, instead of rebuilding a KMove, normalizing
+// its edges through std::set, sorting and hashing at every node of the search.
+// The traversal follows cycle_check::visit_cycle.
+
+#include "BrokenEdge.h"
+#include "cycle_util.hh"
+#include "exchange_pair.hh"
+#include "kmove.hh"
+#include "primitives.hh"
+#include "tour.hh"
+
+#include <algorithm> // lower_bound, sort, unique
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace merge {
+
+class ComboCycles {
+ public:
+    ComboCycles(const Tour &best_tour, const Tour &candidate_tour, const std::vector<ExchangePair> &exchange_pairs) {
+        std::vector<BrokenEdge> removes;
+        std::vector<size_t> remove_pair;
+        std::vector<primitives::point_id_t> points;
+        std::vector<std::array<primitives::point_id_t, 2>> new_edges;
+        new_edge_offsets_.push_back(0);
+        KMove kmove;
+        for (size_t i{0}; i < exchange_pairs.size(); ++i) {
+            kmove.clear();
+            cycle_util::to_kmove(best_tour, candidate_tour, exchange_pairs[i], kmove);
+            for (auto p : kmove.removes) {
+                removes.push_back({p, best_tour.next(p), best_tour.sequence(p, 0)});
+                remove_pair.push_back(i);
+                points.push_back(p);
+                points.push_back(best_tour.next(p));
+            }
+            for (size_t e{0}; e < kmove.starts.size(); ++e) {
+                new_edges.push_back({kmove.starts[e], kmove.ends[e]});
+            }
+            new_edge_offsets_.push_back(new_edges.size());
+        }
+        std::sort(std::begin(points), std::end(points));
+        points.erase(std::unique(std::begin(points), std::end(points)), std::end(points));
+        const auto compact = [&points](primitives::point_id_t p) {
+            return static_cast<Id>(std::lower_bound(std::cbegin(points), std::cend(points), p) - std::cbegin(points));
+        };
+        new_edges_.reserve(new_edges.size());
+        for (const auto &edge : new_edges) {
+            new_edges_.push_back({compact(edge[0]), compact(edge[1])});
+        }
+
+        // positions: removed edges of all pairs in tour order.
+        std::vector<size_t> order(removes.size());
+        for (size_t i{0}; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(std::begin(order), std::end(order), [&removes](auto a, auto b) { return removes[a].sequence < removes[b].sequence; });
+        first_position_.assign(points.size(), NONE);
+        second_position_.assign(points.size(), NONE);
+        for (size_t position{0}; position < order.size(); ++position) {
+            const auto &edge = removes[order[position]];
+            position_first_.push_back(compact(edge.first));
+            position_second_.push_back(compact(edge.second));
+            first_position_[position_first_.back()] = position;
+            second_position_[position_second_.back()] = position;
+        }
+        // group positions by pair (counting sort).
+        position_offsets_.assign(exchange_pairs.size() + 1, 0);
+        for (auto pair : remove_pair) {
+            ++position_offsets_[pair + 1];
+        }
+        for (size_t i{0}; i < exchange_pairs.size(); ++i) {
+            position_offsets_[i + 1] += position_offsets_[i];
+        }
+        pair_positions_.resize(order.size());
+        auto fill = position_offsets_;
+        for (size_t position{0}; position < order.size(); ++position) {
+            pair_positions_[fill[remove_pair[order[position]]]++] = position;
+        }
+        active_.assign((order.size() + 63) / 64, 0);
+        roles_.assign(points.size(), 0);
+        new_degree_.assign(points.size(), 0);
+        new_adjacent_.assign(points.size(), {NONE, NONE});
+        visited_.assign(points.size(), 0);
+    }
+
+    void push(size_t pair) {
+        for (auto p = position_offsets_[pair]; p < position_offsets_[pair + 1]; ++p) {
+            const auto position = pair_positions_[p];
+            active_[position / 64] |= std::uint64_t{1} << (position % 64);
+            add_role(position_first_[position]);
+            add_role(position_second_[position]);
+        }
+        for (auto e = new_edge_offsets_[pair]; e < new_edge_offsets_[pair + 1]; ++e) {
+            const auto &edge = new_edges_[e];
+            connect(edge[0], edge[1]);
+            connect(edge[1], edge[0]);
+        }
+    }
+
+    void pop(size_t pair) {
+        for (auto p = position_offsets_[pair]; p < position_offsets_[pair + 1]; ++p) {
+            const auto position = pair_positions_[p];
+            active_[position / 64] &= ~(std::uint64_t{1} << (position % 64));
+            remove_role(position_first_[position]);
+            remove_role(position_second_[position]);
+        }
+        for (auto e = new_edge_offsets_[pair]; e < new_edge_offsets_[pair + 1]; ++e) {
+            const auto &edge = new_edges_[e];
+            disconnect(edge[0], edge[1]);
+            disconnect(edge[1], edge[0]);
+        }
+    }
+
+    // number of cycles the current tour splits into when the pushed pairs are applied.
+    size_t count_cycles() {
+        ++epoch_;
+        size_t visited{0};
+        size_t cycles{0};
+        for (size_t word{0}; word < active_.size() and visited < active_points_; ++word) {
+            for (auto bits = active_[word]; bits != 0; bits &= bits - 1) {
+                const size_t position = word * 64 + __builtin_ctzll(bits);
+                for (const auto point : {position_first_[position], position_second_[position]}) {
+                    if (visited_[point] != epoch_) {
+                        visited += visit_cycle(point);
+                        ++cycles;
+                    }
+                }
+            }
+        }
+        return cycles;
+    }
+
+    bool breaks_cycle() { return count_cycles() != 1; }
+
+ private:
+    using Id = std::uint32_t;
+    static constexpr Id NONE{std::numeric_limits<Id>::max()};
+
+    // removed edge positions and new edges of pair i: [offsets[i], offsets[i + 1]).
+    std::vector<size_t> position_offsets_;
+    std::vector<size_t> pair_positions_;
+    std::vector<size_t> new_edge_offsets_;
+    std::vector<std::array<Id, 2>> new_edges_;
+    std::vector<Id> position_first_; // (first, second): removed edge (p, next(p)) at each position.
+    std::vector<Id> position_second_;
+    std::vector<size_t> first_position_; // position of the removed edge starting at each point.
+    std::vector<size_t> second_position_; // position of the removed edge ending at each point.
+
+    std::vector<std::uint64_t> active_; // positions of removed edges of pushed pairs.
+    std::vector<std::uint8_t> roles_; // number of removed edges of pushed pairs incident to each point.
+    size_t active_points_{0};
+    std::vector<std::uint8_t> new_degree_;
+    std::vector<std::array<Id, 2>> new_adjacent_;
+    std::vector<std::uint32_t> visited_; // visited in the current count if equal to epoch_.
+    std::uint32_t epoch_{0};
+
+    void add_role(Id point) {
+        if (roles_[point]++ == 0) {
+            ++active_points_;
+        }
+    }
+    void remove_role(Id point) {
+        if (--roles_[point] == 0) {
+            --active_points_;
+        }
+    }
+    void connect(Id point, Id adjacent) {
+        if (new_degree_[point] == 2) {
+            throw std::logic_error("too many adjacent points");
+        }
+        new_adjacent_[point][new_degree_[point]++] = adjacent;
+    }
+    void disconnect(Id point, Id adjacent) {
+        auto &a = new_adjacent_[point];
+        if (a[0] == adjacent) {
+            a[0] = a[1];
+        }
+        a[1] = NONE;
+        --new_degree_[point];
+    }
+
+    bool active(size_t position) const { return (active_[position / 64] >> (position % 64)) & 1; }
+    // next active position after position, cyclically (position itself if it is the only one).
+    size_t next_active(size_t position) const {
+        const size_t words = active_.size();
+        size_t word = (position + 1) / 64;
+        auto bits = (word < words) ? active_[word] & (~std::uint64_t{0} << ((position + 1) % 64)) : 0;
+        for (size_t scanned{0}; bits == 0 and scanned <= words; ++scanned) {
+            word = (word + 1 < words) ? word + 1 : 0;
+            bits = active_[word];
+        }
+        return word * 64 + __builtin_ctzll(bits);
+    }
+    // previous active position before position, cyclically.
+    size_t prev_active(size_t position) const {
+        const size_t words = active_.size();
+        size_t word = position / 64;
+        const auto below = position % 64;
+        auto bits = (below == 0) ? 0 : active_[word] & (~std::uint64_t{0} >> (64 - below));
+        for (size_t scanned{0}; bits == 0 and scanned <= words; ++scanned) {
+            word = (word == 0) ? words - 1 : word - 1;
+            bits = active_[word];
+        }
+        return word * 64 + 63 - __builtin_clzll(bits);
+    }
+
+    // other end of the remaining tour segment that ends at point.
+    Id segment_end(Id point) const {
+        const auto first = first_position_[point];
+        if (first != NONE and active(first)) {
+            return position_second_[prev_active(first)];
+        }
+        return position_first_[next_active(second_position_[point])];
+    }
+
+    bool visit(Id point, size_t &visited) {
+        if (visited_[point] == epoch_) {
+            return false;
+        }
+        visited_[point] = epoch_;
+        ++visited;
+        return true;
+    }
+
+    // returns the number of points visited.
+    size_t visit_cycle(Id current) {
+        size_t visited{0};
+        visit(current, visited);
+        while (true) {
+            // go to next unvisited point in new edge.
+            const auto &new_ends = new_adjacent_[current];
+            current = new_ends[0];
+            if (visited_[current] == epoch_) {
+                if (new_ends[1] == NONE) {
+                    return visited;
+                }
+                current = new_ends[1];
+                if (visited_[current] == epoch_) {
+                    return visited;
+                }
+            }
+            visit(current, visited);
+            // find next new start, connected by old segments.
+            current = segment_end(current);
+            visit(current, visited);
+        }
+    }
+};
+
+}  // namespace merge
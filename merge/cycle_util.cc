@@ -18,17 +18,19 @@ Edge normalize_edge(const Tour &tour, const Edge& mm_edge) {
     throw std::logic_error("invalid edge.");
 }
 
-// Takes edges in (min, max) form and converts them to (i, next(i)) form.
-std::set<Edge> normalize_edges(const Tour& tour, const EdgeMap &edge_map) {
-    std::set<Edge> normalized;
-    for (const auto &pair : edge_map.map()) {
+// Takes edges in (min, max) form and converts them to (i, next(i)) form; sorted, without duplicates.
+std::vector<Edge> normalize_edges(const Tour& tour, const EdgeMap &edge_map) {
+    std::vector<Edge> normalized;
+    for (const auto &pair : edge_map) {
         if (pair.second.first) {
-            normalized.insert(normalize_edge(tour, *pair.second.first));
+            normalized.push_back(normalize_edge(tour, *pair.second.first));
         }
         if (pair.second.second) {
-            normalized.insert(normalize_edge(tour, *pair.second.second));
+            normalized.push_back(normalize_edge(tour, *pair.second.second));
         }
     }
+    std::sort(std::begin(normalized), std::end(normalized));
+    normalized.erase(std::unique(std::begin(normalized), std::end(normalized)), std::end(normalized));
     return normalized;
 }
 
@@ -6,7 +6,6 @@
 #include <tour.hh>
 #include <kmove.hh>
 
-#include <set>
 #include <vector>
 
 namespace merge {
@@ -15,8 +14,8 @@ namespace cycle_util {
 // Takes an edge in (min, max) form and converts it to (i, next(i)) form.
 Edge normalize_edge(const Tour &tour, const Edge& mm_edge);
 
-// Takes edges in (min, max) form and converts them to (i, next(i)) form.
-std::set<Edge> normalize_edges(const Tour& tour, const EdgeMap &edge_map);
+// Takes edges in (min, max) form and converts them to (i, next(i)) form; sorted, without duplicates.
+std::vector<Edge> normalize_edges(const Tour& tour, const EdgeMap &edge_map);
 
 void to_kmove(const Tour &best_tour, const Tour &candidate_tour, const ExchangePair &exchange_pair, KMove &kmove);
 
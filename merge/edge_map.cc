@@ -1,119 +1,198 @@
 #include "edge_map.hh"
 
-#include <iostream>
+#include <algorithm> // fill, max, min
+#include <stdexcept>
 
 namespace merge {
 
 EdgeMap::EdgeMap(const EdgeSet &edge_set) {
+    assign(edge_set);
+}
+
+void EdgeMap::assign(const EdgeSet &edge_set) {
+    clear();
+    reserve(2 * edge_set.size());
     for (const auto &edge : edge_set) {
-        insert(edge);
+        insert(edge.first, edge);
+        insert(edge.second, edge);
     }
 }
 
-auto EdgeMap::insert(const Edge &edge) -> std::optional<Points> {
-    Points new_points;
+void EdgeMap::insert(const Edge &edge, Points &new_points) {
     if (insert(edge.first, edge)) {
         new_points.push_back(edge.first);
     }
     if (insert(edge.second, edge)) {
         new_points.push_back(edge.second);
     }
-    return new_points.empty() ? std::nullopt : make_optional(new_points);
 }
 
-auto EdgeMap::insert(const Edges &edges) -> std::optional<Points> {
-    Points new_points;
+void EdgeMap::insert(const Edges &edges, Points &new_points) {
     for (const auto &edge : edges) {
-        const auto &points = insert(edge);
-        if (points) {
-            new_points.insert(std::cend(new_points), std::cbegin(*points), std::cend(*points));
-        }
+        insert(edge, new_points);
     }
-    return new_points.empty() ? std::nullopt : make_optional(new_points);
 }
 
-bool EdgeMap::insert(primitives::point_id_t i, const Edge &edge) {
-    if (map_.find(i) == std::cend(map_)) {
-        map_[i].first = edge;
-        ++edge_count_;
+bool EdgeMap::insert(Point i, const Edge &edge) {
+    const auto slot = find(i);
+    if (slot == NOT_FOUND) {
+        slots_[add(i)].second.first = edge;
+        ++entry_count_;
         return true;
     }
+    auto &incident = slots_[slot].second;
     // accept insertion of duplicates.
-    if (*map_[i].first == edge or *map_[i].second == edge) {
+    if (incident.first == edge or incident.second == edge) {
         return false;
     }
-    if (not map_[i].first) {
+    if (not incident.first) {
         throw std::logic_error("empty entry.");
     }
-    if (map_[i].second) {
+    if (incident.second) {
         throw std::logic_error("attempted to overfill an entry.");
     }
-    map_[i].second = edge;
-    ++edge_count_;
+    incident.second = edge;
+    ++entry_count_;
     return false;
 }
 
 auto EdgeMap::pop_edge() -> Edge {
-    const auto it = std::begin(map_);
-    auto edge = *it->second.first;
+    while (not occupied(slots_[scan_start_])) {
+        ++scan_start_;
+    }
+    auto edge = *slots_[scan_start_].second.first;
     remove_edges(edge);
     return edge;
 }
 
 void EdgeMap::remove_edges(const Edge &edge) {
-    --edge_count_;
     remove_edge(edge.first, edge);
     remove_edge(edge.second, edge);
 }
 
-void EdgeMap::remove_edge(primitives::point_id_t i, const Edge &edge) {
-    auto it = map_.find(i);
-    if (it == std::cend(map_)) {
+void EdgeMap::remove_edge(Point i, const Edge &edge) {
+    const auto slot = find(i);
+    if (slot == NOT_FOUND) {
         return;
     }
-    if (*map_[i].first == edge) {
-        std::swap(map_[i].first, map_[i].second);
-        map_[i].second = std::nullopt;
-        if (not map_[i].first) {
-            map_.erase(it);
-        }
+    auto &incident = slots_[slot].second;
+    if (incident.second == edge) {
+        incident.second = std::nullopt;
+        --entry_count_;
+    } else if (incident.first == edge) {
+        incident.first = incident.second;
+        incident.second = std::nullopt;
+        --entry_count_;
     }
-    if (*map_[i].second == edge) {
-        map_[i].second = std::nullopt;
+    if (not incident.first) {
+        erase(slot);
     }
 }
 
-auto EdgeMap::pop_edges(const Point &i) -> std::optional<Edges> {
-    auto it = map_.find(i);
-    if (it == std::cend(map_)) {
-        return std::nullopt;
+void EdgeMap::pop_edges(Point i, Edges &popped) {
+    const auto slot = find(i);
+    if (slot == NOT_FOUND) {
+        return;
     }
-    auto edge_pair = it->second;
-    map_.erase(it);
-    EdgeMap::Edges edges;
-    if (edge_pair.first) {
-        --edge_count_;
-        edges.push_back(*edge_pair.first);
+    const auto incident = slots_[slot].second;
+    erase(slot);
+    if (incident.first) {
+        --entry_count_;
+        popped.push_back(*incident.first);
     }
-    if (edge_pair.second) {
-        --edge_count_;
-        edges.push_back(*edge_pair.second);
+    if (incident.second) {
+        --entry_count_;
+        popped.push_back(*incident.second);
     }
-    return edges;
 }
 
-auto EdgeMap::pop_edges(const Points &points) -> std::optional<Edges> {
-    Edges edges;
+void EdgeMap::pop_edges(const Points &points, Edges &popped) {
     for (const auto &i : points) {
-        const auto popped = pop_edges(i);
-        if (popped) {
-            edges.insert(std::cend(edges), std::cbegin(*popped), std::cend(*popped));
+        pop_edges(i, popped);
+    }
+}
+
+void EdgeMap::clear() {
+    if (size_ + erased_ > 0) {
+        std::fill(std::begin(slots_), std::end(slots_), Entry{EMPTY, {}});
+    }
+    size_ = 0;
+    erased_ = 0;
+    scan_start_ = 0;
+    entry_count_ = 0;
+}
+
+void EdgeMap::reserve(size_t point_count) {
+    // keep the load factor at most 3/4.
+    if (4 * point_count > 3 * slots_.size()) {
+        size_t slot_count{MIN_SLOTS};
+        while (3 * slot_count < 4 * point_count) {
+            slot_count *= 2;
         }
+        rehash(slot_count);
     }
-    if (edges.empty()) {
-        return std::nullopt;
+}
+
+size_t EdgeMap::find(Point i) const {
+    if (slots_.empty()) {
+        return NOT_FOUND;
+    }
+    const auto mask = slots_.size() - 1;
+    for (auto slot = home(i); ; slot = (slot + 1) & mask) {
+        const auto &key = slots_[slot].first;
+        if (key == i) {
+            return slot;
+        }
+        if (key == EMPTY) {
+            return NOT_FOUND;
+        }
+    }
+}
+
+size_t EdgeMap::add(Point i) {
+    if (4 * (size_ + erased_ + 1) > 3 * slots_.size()) {
+        // grow only if the map fills up, rather than erased slots.
+        rehash(std::max(MIN_SLOTS, 4 * (size_ + 1) > 3 * slots_.size() / 2 ? 2 * slots_.size() : slots_.size()));
+    }
+    const auto mask = slots_.size() - 1;
+    auto slot = home(i);
+    while (occupied(slots_[slot])) {
+        slot = (slot + 1) & mask;
+    }
+    if (slots_[slot].first == ERASED) {
+        --erased_;
+    }
+    slots_[slot] = {i, {}};
+    ++size_;
+    scan_start_ = std::min(scan_start_, slot);
+    return slot;
+}
+
+void EdgeMap::erase(size_t slot) {
+    slots_[slot] = {ERASED, {}};
+    --size_;
+    ++erased_;
+}
+
+void EdgeMap::rehash(size_t slot_count) {
+    std::vector<Entry> old(slot_count, Entry{EMPTY, {}});
+    std::swap(old, slots_);
+    shift_ = 64;
+    for (auto s = slot_count; s > 1; s /= 2) {
+        --shift_;
+    }
+    const auto mask = slot_count - 1;
+    for (const auto &entry : old) {
+        if (occupied(entry)) {
+            auto slot = home(entry.first);
+            while (slots_[slot].first != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+            slots_[slot] = entry;
+        }
     }
-    return edges;
+    erased_ = 0;
+    scan_start_ = 0;
 }
 
 }  // namespace merge
@@ -1,15 +1,19 @@
 #pragma once
 
 // Maps points to their edges.
+// Open addressing (linear probing) in a single flat array, so that a map costs one allocation rather
+// than one per point, and clear() keeps the array for reuse by the next merge.
 
 #include "edge.hh"
 #include "edge_set.hh"
 
 #include <primitives.hh>
 
-#include <unordered_map>
-#include <vector>
+#include <cstdint>
+#include <limits>
 #include <optional>
+#include <utility>
+#include <vector>
 
 namespace merge {
 
@@ -18,34 +22,89 @@ struct EdgeMap {
     using Points = std::vector<Point>;
     using Edges = std::vector<Edge>;
     using IncidentEdges = std::pair<std::optional<Edge>, std::optional<Edge>>;
+    using Entry = std::pair<Point, IncidentEdges>;
+
+    // iterates over (point, incident edges) entries, in no particular order.
+    class const_iterator {
+     public:
+        const_iterator(const Entry *slot, const Entry *end) : slot_(slot), end_(end) { skip(); }
+        const Entry &operator*() const { return *slot_; }
+        const Entry *operator->() const { return slot_; }
+        const_iterator &operator++() {
+            ++slot_;
+            skip();
+            return *this;
+        }
+        bool operator!=(const const_iterator &other) const { return slot_ != other.slot_; }
+        bool operator==(const const_iterator &other) const { return slot_ == other.slot_; }
+
+     private:
+        const Entry *slot_;
+        const Entry *end_;
+        void skip() {
+            while (slot_ != end_ and not occupied(*slot_)) {
+                ++slot_;
+            }
+        }
+    };
+
  public:
     EdgeMap() = default;
     EdgeMap(const EdgeSet &edge_set);
 
-    std::optional<Points> insert(const Edge &edge);
-    std::optional<Points> insert(const Edges &edges);
+    // Inserts edges; points not in the map before are appended to new_points.
+    void insert(const Edge &edge, Points &new_points);
+    void insert(const Edges &edges, Points &new_points);
     Edge pop_edge();
-    std::optional<Edges> pop_edges(const Points &points);
+    // Removes the edges of points and appends them to popped.
+    void pop_edges(const Points &points, Edges &popped);
+
+    bool empty() const { return size_ == 0; }
+    // Removes all entries; keeps the allocated slots.
+    void clear();
+    // Replaces the entries with edge_set.
+    void assign(const EdgeSet &edge_set);
+    void reserve(size_t point_count);
 
-    bool empty() const { return map_.empty(); }
-    const auto &map() const { return map_; }
+    const_iterator begin() const { return {slots_.data(), slots_.data() + slots_.size()}; }
+    const_iterator end() const { return {slots_.data() + slots_.size(), slots_.data() + slots_.size()}; }
 
-    size_t edge_count() const { return edge_count_; }
+    // Edges inserted at both of their points count once.
+    size_t edge_count() const { return entry_count_ / 2; }
 
  private:
-    std::optional<Edges> pop_edges(const Point &i);
+    static constexpr Point EMPTY{std::numeric_limits<Point>::max()};
+    static constexpr Point ERASED{EMPTY - 1};
+    static constexpr size_t NOT_FOUND{std::numeric_limits<size_t>::max()};
+    static constexpr size_t MIN_SLOTS{16};
+
+    static bool occupied(const Entry &entry) { return entry.first < ERASED; }
+
+    void pop_edges(Point i, Edges &popped);
 
     // Returns true if i is new.
-    bool insert(primitives::point_id_t i, const Edge &edge);
+    bool insert(Point i, const Edge &edge);
 
     // remove edge entries for both points in the edge.
     void remove_edges(const Edge &edge);
-    void remove_edge(primitives::point_id_t i, const Edge &edge);
-
-    // Maps each point to the edges that said point is a part of. Each edge is stored twice, once for each point.
-    std::unordered_map<Point, IncidentEdges> map_;
-
-    size_t edge_count_{0};
+    void remove_edge(Point i, const Edge &edge);
+
+    size_t home(Point i) const { return (i * std::uint64_t{0x9E3779B97F4A7C15}) >> shift_; }
+    size_t find(Point i) const;
+    // Slot of a new entry for i (which must not be in the map).
+    size_t add(Point i);
+    void erase(size_t slot);
+    void rehash(size_t slot_count);
+
+    // Each edge is stored twice, once for each of its points.
+    std::vector<Entry> slots_;
+    int shift_{64}; // 64 - log2(slot count).
+    size_t size_{0}; // number of points.
+    size_t erased_{0}; // number of erased slots, which still end probe sequences only when EMPTY.
+    size_t scan_start_{0}; // no occupied slot before this (for pop_edge).
+
+    // number of (point, edge) entries.
+    size_t entry_count_{0};
 
 };
 
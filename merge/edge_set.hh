@@ -2,11 +2,12 @@
 
 #include "edge.hh"
 
-#include <set>
+#include <vector>
 
 namespace merge {
 
-using EdgeSet = std::set<Edge>;
+// sorted, without duplicates.
+using EdgeSet = std::vector<Edge>;
 
 }  // namespace merge
 
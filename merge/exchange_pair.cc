@@ -9,10 +9,10 @@ int ExchangePair::compute_improvement(const std::vector<primitives::space_t> &x,
     LengthCalculator calc(x, y);
     improvement = std::make_optional<int>(0);
     // note that each edge has 2 entries in the map.
-    for (const auto &pair : current.map()) {
+    for (const auto &pair : current) {
         *improvement += cost(pair.second, calc);
     }
-    for (const auto &pair : candidate.map()) {
+    for (const auto &pair : candidate) {
         *improvement -= cost(pair.second, calc);
     }
     if ((*improvement & 1) == 1) { // odd
@@ -14,8 +14,16 @@ namespace merge {
 struct ExchangePair {
     EdgeMap current, candidate;
     std::optional<int> improvement{std::nullopt};
+    std::optional<bool> cycle_breaking{std::nullopt}; // true if applying only this pair splits the tour.
 
     bool empty() const { return current.empty() and candidate.empty(); }
+    // Removes all edges; keeps the maps' allocations.
+    void clear() {
+        current.clear();
+        candidate.clear();
+        improvement.reset();
+        cycle_breaking.reset();
+    }
     int compute_improvement(const std::vector<primitives::space_t> &x, const std::vector<primitives::space_t> &y);
 
     size_t edge_count() const {
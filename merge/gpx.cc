@@ -0,0 +1,152 @@
+#include "gpx.hh"
+
+#include "cycle_util.hh"
+#include "edge.hh"
+#include "exchange_pair.hh"
+#include "merge.hh"
+#include "telemetry.hh"
+#include <trace.hh>
+
+#include <algorithm> // lower_bound, sort
+#include <stdexcept>
+#include <utility> // pair
+
+namespace merge {
+
+namespace {
+
+size_t find_root(std::vector<size_t> &parent, size_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+}  // namespace
+
+std::optional<KMove> partition_crossover(Tour &current_tour, const Tour &candidate_tour) {
+    const auto [old_edges, new_edges] = edge_differences(current_tour, candidate_tour);
+    return partition_crossover(current_tour, candidate_tour, old_edges, new_edges);
+}
+
+std::optional<KMove> partition_crossover(Tour &current_tour
+    , const Tour &candidate_tour
+    , const std::vector<primitives::point_id_t> &touched_points) {
+    const auto [old_edges, new_edges] = edge_differences(current_tour, candidate_tour, touched_points);
+    return partition_crossover(current_tour, candidate_tour, old_edges, new_edges);
+}
+
+std::optional<KMove> partition_crossover(Tour &current_tour
+    , const Tour &candidate_tour
+    , const EdgeSet &old_edges
+    , const EdgeSet &new_edges) {
+    TRACE(debug, "edge diff count: " << old_edges.size());
+    if (old_edges.empty()) {
+        return std::nullopt;
+    }
+    auto &stats = telemetry();
+    stats.merges.add();
+    stats.diff_edges.add(old_edges.size());
+    auto components = disjoin(old_edges, new_edges);
+    // component of each point of a differing edge.
+    std::vector<std::pair<primitives::point_id_t, size_t>> point_components;
+    for (size_t c{0}; c < components.size(); ++c) {
+        components[c].compute_improvement(current_tour.x(), current_tour.y());
+        for (const auto &entry : components[c].current) {
+            point_components.emplace_back(entry.first, c);
+        }
+    }
+    std::sort(std::begin(point_components), std::end(point_components));
+    const auto component = [&point_components](primitives::point_id_t p) {
+        return std::lower_bound(std::cbegin(point_components), std::cend(point_components), std::make_pair(p, size_t{0}))->second;
+    };
+
+    // Between consecutive differing edges of the current tour (in tour order) lies a path of common edges,
+    // unless the edges share a point. A path between different components is a cut path of both.
+    std::vector<std::pair<primitives::sequence_t, primitives::point_id_t>> removes; // (sequence, p): edge (p, next(p)).
+    for (const auto &edge : old_edges) {
+        const auto p = cycle_util::normalize_edge(current_tour, edge).first;
+        removes.emplace_back(current_tour.sequence(p, 0), p);
+    }
+    std::sort(std::begin(removes), std::end(removes));
+    std::vector<size_t> cut(components.size(), 0);
+    std::vector<std::pair<size_t, size_t>> cut_paths;
+    for (size_t k{0}; k < removes.size(); ++k) {
+        const auto path_start = current_tour.next(removes[k].second);
+        const auto path_end = removes[(k + 1) % removes.size()].second;
+        if (path_start == path_end) {
+            continue;
+        }
+        const auto a = component(path_start);
+        const auto b = component(path_end);
+        if (a != b) {
+            ++cut[a];
+            ++cut[b];
+            cut_paths.emplace_back(a, b);
+        }
+    }
+
+    // fuse infeasible components connected by cut paths; the cut size of a group excludes the paths inside it.
+    constexpr size_t FEASIBLE_CUT{2};
+    std::vector<size_t> parent(components.size());
+    for (size_t c{0}; c < components.size(); ++c) {
+        parent[c] = c;
+    }
+    for (const auto &[a, b] : cut_paths) {
+        if (cut[a] > FEASIBLE_CUT and cut[b] > FEASIBLE_CUT) {
+            parent[find_root(parent, a)] = find_root(parent, b);
+        }
+    }
+    std::vector<size_t> group_cut(components.size(), 0);
+    std::vector<int> group_improvement(components.size(), 0);
+    for (size_t c{0}; c < components.size(); ++c) {
+        const auto root = find_root(parent, c);
+        group_cut[root] += cut[c];
+        group_improvement[root] += *components[c].improvement;
+    }
+    for (const auto &[a, b] : cut_paths) {
+        const auto root = find_root(parent, a);
+        if (root == find_root(parent, b)) {
+            group_cut[root] -= 2;
+        }
+    }
+
+    std::vector<size_t> selected;
+    int improvement{0};
+    size_t feasible{0};
+    for (size_t c{0}; c < components.size(); ++c) {
+        const auto root = find_root(parent, c);
+        if (group_cut[root] > FEASIBLE_CUT) {
+            continue;
+        }
+        if (root == c) {
+            ++feasible;
+            if (group_improvement[root] > 0) {
+                improvement += group_improvement[root];
+            }
+        }
+        if (group_improvement[root] > 0) {
+            selected.push_back(c);
+        }
+    }
+    stats.exchanges.add(components.size());
+    TRACE(debug, "partition components: " << components.size()
+        << ", feasible (incl. fused groups): " << feasible
+        << ", applied components: " << selected.size());
+    if (selected.empty()) {
+        return std::nullopt;
+    }
+    const auto old_length = current_tour.length();
+    const auto &kmove = cycle_util::to_kmove(current_tour, candidate_tour, components, selected);
+    current_tour.swap(kmove);
+    const auto new_length = current_tour.length();
+    if (static_cast<int>(old_length) - static_cast<int>(new_length) != improvement) {
+        throw std::logic_error("Tour length after partition crossover is inconsistent with expected improvement.");
+    }
+    stats.improving_merges.add();
+    stats.improvement.add(improvement);
+    return kmove;
+}
+
+}  // namespace merge
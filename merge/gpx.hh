@@ -0,0 +1,32 @@
+#pragma once
+
+// Partition crossover (GPX): a linear-time alternative to the Combinator search of merge::merge.
+// Removing the edges common to both tours splits their union into components, which are the
+// exchange pairs of difference decomposition. A component that the common edges connect to the rest
+// of the tour by 2 paths (cut size 2; 0 if it is the only one) is entered and left once by both tours, so either
+// tour's edges inside it can be chosen independently of all other components. Infeasible components
+// that common paths connect to each other are fused, and the fused group is feasible if its cut size is 2.
+// The candidate's side of every feasible component or group that is shorter is applied to the current tour.
+
+#include "edge_set.hh"
+#include "kmove.hh"
+#include "primitives.hh"
+#include "tour.hh"
+
+#include <optional>
+#include <vector>
+
+namespace merge {
+
+std::optional<KMove> partition_crossover(Tour &current_tour, const Tour &candidate_tour);
+// Only compares touched_points (see merge.hh).
+std::optional<KMove> partition_crossover(Tour &current_tour
+    , const Tour &candidate_tour
+    , const std::vector<primitives::point_id_t> &touched_points);
+// Recombines given differing edges (from edge_differences).
+std::optional<KMove> partition_crossover(Tour &current_tour
+    , const Tour &candidate_tour
+    , const EdgeSet &old_edges
+    , const EdgeSet &new_edges);
+
+}  // namespace merge
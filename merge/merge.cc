@@ -4,17 +4,34 @@
 #include "edge_map.hh"
 #include "exchange_pair.hh"
 #include "combinator.hh"
+#include "combo_cycles.hh"
 #include "cycle_util.hh"
+#include "telemetry.hh"
 #include <kmove.hh>
 #include <length_calculator.hh>
 #include <cycle_check.hh>
+#include <trace.hh>
 
-#include <fstream>
+#include <memory> // unique_ptr
+#include <sstream>
 
 namespace merge {
 
+Telemetry &telemetry() {
+    static Telemetry telemetry;
+    return telemetry;
+}
+
 namespace {
 
+std::string edge_list(const EdgeSet &edges) {
+    std::ostringstream list;
+    for (const auto &e : edges) {
+        list << e.first << ' ' << e.second << '\n';
+    }
+    return list.str();
+}
+
 template <typename AdjacentsContainer>
 std::pair<primitives::point_id_t, primitives::point_id_t> sorted_pair(
     const AdjacentsContainer &adjacents,
@@ -49,89 +66,228 @@ bool is_sequence(std::vector<primitives::point_id_t> &point_container, primitive
     return true;
 }
 
-}  // namespace
+// adds the edges of point i that differ between the tours.
+template <typename AdjacentsContainer>
+void add_differences(const AdjacentsContainer &adjacents1
+    , const AdjacentsContainer &adjacents2
+    , primitives::point_id_t i
+    , EdgeSet &diff1
+    , EdgeSet &diff2) {
+    const auto &sorted1 = sorted_pair(adjacents1, i);
+    const auto &sorted2 = sorted_pair(adjacents2, i);
+    if (sorted1 == sorted2) {
+        return;
+    }
+    const auto diff11 = sorted1.first != sorted2.first;
+    const auto diff12 = sorted1.first != sorted2.second;
+    const auto diff21 = sorted1.second != sorted2.first;
+    const auto diff22 = sorted1.second != sorted2.second;
+    if (diff11 and diff12) {
+        const auto j = sorted1.first;
+        diff1.emplace_back(std::min(i, j), std::max(i, j));
+    }
+    if (diff21 and diff22) {
+        const auto j = sorted1.second;
+        diff1.emplace_back(std::min(i, j), std::max(i, j));
+    }
+    if (diff11 and diff21) {
+        const auto j = sorted2.first;
+        diff2.emplace_back(std::min(i, j), std::max(i, j));
+    }
+    if (diff12 and diff22) {
+        const auto j = sorted2.second;
+        diff2.emplace_back(std::min(i, j), std::max(i, j));
+    }
+}
 
-std::pair<EdgeSet, EdgeSet> edge_differences(const Tour &tour1, const Tour &tour2) {
-    const auto &adjacents1 = tour1.adjacents();
-    const auto &adjacents2 = tour2.adjacents();
-    EdgeSet diff1, diff2;
-    for (primitives::point_id_t i{0}; i < adjacents1.size(); ++i) {
-        const auto &sorted1 = sorted_pair(adjacents1, i);
-        const auto &sorted2 = sorted_pair(adjacents2, i);
-        if (sorted1 == sorted2) {
-            continue;
-        }
-        const auto diff11 = sorted1.first != sorted2.first;
-        const auto diff12 = sorted1.first != sorted2.second;
-        const auto diff21 = sorted1.second != sorted2.first;
-        const auto diff22 = sorted1.second != sorted2.second;
-        if (diff11 and diff12) {
-            const auto j = sorted1.first;
-            diff1.emplace(std::min(i, j), std::max(i, j));
-        }
-        if (diff21 and diff22) {
-            const auto j = sorted1.second;
-            diff1.emplace(std::min(i, j), std::max(i, j));
-        }
-        if (diff11 and diff21) {
-            const auto j = sorted2.first;
-            diff2.emplace(std::min(i, j), std::max(i, j));
-        }
-        if (diff12 and diff22) {
-            const auto j = sorted2.second;
-            diff2.emplace(std::min(i, j), std::max(i, j));
-        }
+// sorts differing edges (found once from each of their points) and checks their counts.
+void finish_differences(EdgeSet &diff1, EdgeSet &diff2) {
+    for (auto *diff : {&diff1, &diff2}) {
+        std::sort(std::begin(*diff), std::end(*diff));
+        diff->erase(std::unique(std::begin(*diff), std::end(*diff)), std::end(*diff));
     }
     if (diff2.size() != diff1.size()) {
         throw std::logic_error("number of different edges are not the same between tours.");
     }
-    return {std::move(diff1), std::move(diff2)};
 }
 
-ExchangePair disjoin(ExchangePair &base) {
-    ExchangePair disjoined;
-    auto new_points = disjoined.current.insert({base.current.pop_edge()});
-    while (new_points) {
-        new_points = disjoined.candidate.insert(*base.candidate.pop_edges(*new_points));
-        if (not new_points) {
+void edge_differences(const Tour &tour1, const Tour &tour2, EdgeSet &diff1, EdgeSet &diff2) {
+    diff1.clear();
+    diff2.clear();
+    for (primitives::point_id_t i{0}; i < tour1.size(); ++i) {
+        add_differences(tour1.adjacents(), tour2.adjacents(), i, diff1, diff2);
+    }
+    finish_differences(diff1, diff2);
+}
+
+void edge_differences(const Tour &tour1
+    , const Tour &tour2
+    , const std::vector<primitives::point_id_t> &touched_points
+    , EdgeSet &diff1
+    , EdgeSet &diff2) {
+    diff1.clear();
+    diff2.clear();
+    for (auto i : touched_points) {
+        add_differences(tour1.adjacents(), tour2.adjacents(), i, diff1, diff2);
+    }
+    finish_differences(diff1, diff2);
+}
+
+// Containers reused by the merges of a thread, so that a merge only allocates
+// when it is larger than the previous ones.
+struct Workspace {
+    EdgeSet old_edges, new_edges;
+    ExchangePair base;
+    EdgeMap::Points new_points;
+    EdgeMap::Edges popped;
+    std::vector<ExchangePair> exchanges;
+    std::vector<ExchangePair> spare; // cleared exchange pairs, whose maps keep their slots.
+    std::vector<primitives::sequence_t> sequence;
+    std::unique_ptr<parallel::ThreadPool> pool; // of the last parallel combinator search.
+};
+
+Workspace &workspace() {
+    thread_local Workspace workspace;
+    return workspace;
+}
+
+void disjoin(ExchangePair &base, ExchangePair &disjoined, EdgeMap::Points &new_points, EdgeMap::Edges &popped) {
+    new_points.clear();
+    disjoined.current.insert(base.current.pop_edge(), new_points);
+    while (not new_points.empty()) {
+        popped.clear();
+        base.candidate.pop_edges(new_points, popped);
+        new_points.clear();
+        disjoined.candidate.insert(popped, new_points);
+        if (new_points.empty()) {
             break;
         }
-        new_points = disjoined.current.insert(*base.current.pop_edges(*new_points));
+        popped.clear();
+        base.current.pop_edges(new_points, popped);
+        new_points.clear();
+        disjoined.current.insert(popped, new_points);
     }
+}
+
+// moves the exchange pairs that match predicate to the spare pairs, keeping the order of the others.
+template <typename Predicate>
+void recycle_if(Workspace &workspace, Predicate predicate) {
+    auto &exchanges = workspace.exchanges;
+    size_t kept{0};
+    for (size_t i{0}; i < exchanges.size(); ++i) {
+        if (not predicate(exchanges[i])) {
+            if (kept != i) {
+                std::swap(exchanges[kept], exchanges[i]);
+            }
+            ++kept;
+        }
+    }
+    while (exchanges.size() > kept) {
+        exchanges.back().clear();
+        workspace.spare.push_back(std::move(exchanges.back()));
+        exchanges.pop_back();
+    }
+}
+
+// Fills workspace.exchanges with the exchange pairs of workspace.old_edges and workspace.new_edges.
+void disjoin(Workspace &workspace) {
+    recycle_if(workspace, [](const auto &) { return true; });
+    auto &base = workspace.base;
+    base.current.assign(workspace.old_edges);
+    base.candidate.assign(workspace.new_edges);
+    while (not base.empty()) {
+        if (workspace.spare.empty()) {
+            workspace.spare.emplace_back();
+        }
+        workspace.exchanges.push_back(std::move(workspace.spare.back()));
+        workspace.spare.pop_back();
+        disjoin(base, workspace.exchanges.back(), workspace.new_points, workspace.popped);
+    }
+}
+
+std::optional<KMove> merge(Tour &current_tour, const Tour &candidate_tour, Workspace &workspace, const CombinatorBudget &budget);
+
+}  // namespace
+
+std::pair<EdgeSet, EdgeSet> edge_differences(const Tour &tour1, const Tour &tour2) {
+    EdgeSet diff1, diff2;
+    edge_differences(tour1, tour2, diff1, diff2);
+    return {std::move(diff1), std::move(diff2)};
+}
+
+std::pair<EdgeSet, EdgeSet> edge_differences(const Tour &tour1, const Tour &tour2, const std::vector<primitives::point_id_t> &touched_points) {
+    EdgeSet diff1, diff2;
+    edge_differences(tour1, tour2, touched_points, diff1, diff2);
+    return {std::move(diff1), std::move(diff2)};
+}
+
+ExchangePair disjoin(ExchangePair &base) {
+    ExchangePair disjoined;
+    EdgeMap::Points new_points;
+    EdgeMap::Edges popped;
+    disjoin(base, disjoined, new_points, popped);
     return disjoined;
 }
 
 std::vector<ExchangePair> disjoin(const EdgeSet &current_edges, const EdgeSet &candidate_edges) {
-    EdgeMap current(current_edges);
-    EdgeMap candidate(candidate_edges);
-    ExchangePair base{std::move(current), std::move(candidate)};
+    ExchangePair base{current_edges, candidate_edges};
     std::vector<ExchangePair> exchange_pairs;
     while (not base.empty()) {
-        exchange_pairs.push_back(std::move(disjoin(base)));
+        exchange_pairs.push_back(disjoin(base));
     }
     return exchange_pairs;
 }
 
-std::optional<KMove> merge(Tour &current_tour, const Tour &candidate_tour) {
-    const auto [old_edges, new_edges] = merge::edge_differences(current_tour, candidate_tour);
+std::optional<KMove> merge(Tour &current_tour, const Tour &candidate_tour, const CombinatorBudget &budget) {
+    auto &workspace = merge::workspace();
+    edge_differences(current_tour, candidate_tour, workspace.old_edges, workspace.new_edges);
+    return merge(current_tour, candidate_tour, workspace, budget);
+}
+
+std::optional<KMove> merge(Tour &current_tour
+    , const Tour &candidate_tour
+    , const std::vector<primitives::point_id_t> &touched_points
+    , const CombinatorBudget &budget) {
+    auto &workspace = merge::workspace();
+    edge_differences(current_tour, candidate_tour, touched_points, workspace.old_edges, workspace.new_edges);
+    return merge(current_tour, candidate_tour, workspace, budget);
+}
+
+std::optional<KMove> merge(Tour &current_tour
+    , const Tour &candidate_tour
+    , const EdgeSet &old_edges
+    , const EdgeSet &new_edges
+    , const CombinatorBudget &budget) {
+    auto &workspace = merge::workspace();
+    workspace.old_edges = old_edges;
+    workspace.new_edges = new_edges;
+    return merge(current_tour, candidate_tour, workspace, budget);
+}
+
+namespace {
+
+std::optional<KMove> merge(Tour &current_tour, const Tour &candidate_tour, Workspace &workspace, const CombinatorBudget &budget) {
+    const auto &old_edges = workspace.old_edges;
+    const auto &new_edges = workspace.new_edges;
     if (old_edges.size() != new_edges.size()) {
         throw std::logic_error("edge diff set does not comprise of the same number of edges from both tours.");
     }
-    std::cout << "edge diff count: " << old_edges.size() << std::endl;
+    TRACE(debug, "edge diff count: " << old_edges.size());
     if (old_edges.empty()) {
         return std::nullopt;
     }
-
-    std::ofstream old_edge_file("output/old_edges.txt", std::ofstream::out);
-    for (const auto &e : old_edges) {
-        old_edge_file << e.first << ' ' << e.second << std::endl;
-    }
-    std::ofstream new_edge_file("output/new_edges.txt", std::ofstream::out);
-    for (const auto &e : new_edges) {
-        new_edge_file << e.first << ' ' << e.second << std::endl;
+    auto &stats = telemetry();
+    stats.merges.add();
+    stats.diff_edges.add(old_edges.size());
+    if (trace::enabled(trace::Level::verbose)) {
+        // for plot_edges.py.
+        trace::dump("output/old_edges.txt", edge_list(old_edges));
+        trace::dump("output/new_edges.txt", edge_list(new_edges));
     }
 
-    auto exchanges = disjoin(old_edges, new_edges);
+    disjoin(workspace);
+    auto &exchanges = workspace.exchanges;
+    stats.exchanges.add(exchanges.size());
     if (exchanges.empty()) {
         return std::nullopt;
     }
@@ -147,41 +303,56 @@ std::optional<KMove> merge(Tour &current_tour, const Tour &candidate_tour) {
         return std::nullopt;
     }
 
+    ComboCycles pair_cycles(current_tour, candidate_tour, exchanges);
+    for (size_t i{0}; i < exchanges.size(); ++i) {
+        pair_cycles.push(i);
+        exchanges[i].cycle_breaking = pair_cycles.breaks_cycle();
+        pair_cycles.pop(i);
+    }
+
     // check to see if exchange pair is useless, meaning zero-cost and non-cycle-breaking.
     // returns true if useless, e.g. should be excluded.
-    const auto useless = [&current_tour, &candidate_tour](const ExchangePair &ex) {
+    const auto useless = [&current_tour, &sequence = workspace.sequence](const ExchangePair &ex) {
         if (*ex.improvement > 0) {
             return false;
         }
-        std::vector<primitives::sequence_t> sequence;
-        for (const auto &pair : ex.candidate.map()) {
+        sequence.clear();
+        for (const auto &pair : ex.candidate) {
             constexpr primitives::point_id_t START_POINT{0};
             sequence.push_back(current_tour.sequence(pair.first, START_POINT));
         }
         std::sort(std::begin(sequence), std::end(sequence));
-        return is_sequence(sequence, current_tour.size()) or !cycle_util::breaks_cycle(current_tour, candidate_tour, ex);
+        return is_sequence(sequence, current_tour.size()) or not *ex.cycle_breaking;
     };
-    exchanges.erase(std::remove_if(std::begin(exchanges), std::end(exchanges), useless), std::end(exchanges));
+    recycle_if(workspace, useless);
     // max gain, exclude too-low edges.
     const int max_total_improvement = std::accumulate(std::cbegin(exchanges), std::cend(exchanges), int(0), [](int sum, const auto &ex) { return sum + std::max(*ex.improvement, 0); });
-    std::cout << "max total improvement: " << max_total_improvement << std::endl;
-    exchanges.erase(std::remove_if(std::begin(exchanges), std::end(exchanges), [max_total_improvement](const auto &ex) { return *ex.improvement + max_total_improvement <= 0; }), std::end(exchanges));
-    std::cout << "removed " << original_exchange_size - exchanges.size() << " useless exchange(s).\n";
-    std::cout << exchanges.size() << " distinct exchange(s)." << std::endl;
-    size_t i{0};
-    for (auto &ex : exchanges) {
-        std::cout << i << ": improvement: " << ex.compute_improvement(current_tour.x(), current_tour.y()) << " ("
-            << ex.edge_count() << " edges, breaks cycle: "
-            << cycle_util::breaks_cycle(current_tour, candidate_tour, ex) << ")" << std::endl;
-        ++i;
-    }
-
-    Combinator combinator(exchanges, current_tour, candidate_tour);
+    TRACE(debug, "max total improvement: " << max_total_improvement);
+    recycle_if(workspace, [max_total_improvement](const auto &ex) { return *ex.improvement + max_total_improvement <= 0; });
+    stats.useless_exchanges.add(original_exchange_size - exchanges.size());
+    TRACE(debug, "removed " << original_exchange_size - exchanges.size() << " useless exchange(s); "
+        << exchanges.size() << " distinct exchange(s).");
+    if (trace::enabled(trace::Level::verbose)) {
+        for (size_t i{0}; i < exchanges.size(); ++i) {
+            const auto &ex = exchanges[i];
+            TRACE(verbose, i << ": improvement: " << *ex.improvement << " ("
+                << ex.edge_count() << " edges, breaks cycle: "
+                << *ex.cycle_breaking << ")");
+        }
+    }
+
+    if (budget.threads > 1 and (not workspace.pool or workspace.pool->size() != budget.threads)) {
+        workspace.pool = std::make_unique<parallel::ThreadPool>(budget.threads);
+    }
+    Combinator combinator(exchanges, current_tour, candidate_tour, budget, workspace.pool.get());
     combinator.find();
-    std::cout << "move combos checked: " << combinator.checks() << std::endl;
-    if (combinator.viable_count() > 0) {
-        std::cout << "viable combos: " << combinator.viable_count() << std::endl;
+    stats.combos_checked.add(combinator.checks());
+    if (combinator.exhausted()) {
+        stats.exhausted_budgets.add();
     }
+    TRACE(debug, "move combos checked: " << combinator.checks()
+        << ", viable combos: " << combinator.viable_count()
+        << (combinator.exhausted() ? " (budget exhausted; using best combo found so far)" : ""));
     if (combinator.best_combo()) {
         const auto old_length = current_tour.length();
         const auto &kmove = cycle_util::to_kmove(current_tour, candidate_tour, exchanges, *combinator.best_combo());
@@ -190,9 +361,13 @@ std::optional<KMove> merge(Tour &current_tour, const Tour &candidate_tour) {
         if (static_cast<int>(old_length) - static_cast<int>(new_length) != *combinator.best_improvement()) {
             throw std::logic_error("Tour length after swap is inconsistent with expected improvement.");
         }
+        stats.improving_merges.add();
+        stats.improvement.add(*combinator.best_improvement());
         return kmove;
     }
     return std::nullopt;
 }
 
+}  // namespace
+
 }  // namespace merge
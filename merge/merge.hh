@@ -1,5 +1,6 @@
 #pragma once
 
+#include "combinator.hh"
 #include "edge_set.hh"
 #include "exchange_pair.hh"
 #include "tour.hh"
@@ -16,11 +17,27 @@ namespace merge {
 using ExchangeSet = std::pair<EdgeSet, EdgeSet>;
 
 std::pair<EdgeSet, EdgeSet> edge_differences(const Tour &tour1, const Tour &tour2);
+// Only compares the adjacents of touched_points, which must include every point whose adjacents differ.
+std::pair<EdgeSet, EdgeSet> edge_differences(const Tour &tour1, const Tour &tour2, const std::vector<primitives::point_id_t> &touched_points);
 
 // Removes a disjoint ExchangePair from base.
 ExchangePair disjoin(ExchangePair &base);
 std::vector<ExchangePair> disjoin(const EdgeSet &current, const EdgeSet &candidate);
 
-std::optional<KMove> merge(Tour &current_tour, const Tour &candidate_tour);
+// budget limits the search over combinations of differing edge sets (exchange pairs);
+// by default it is serial and exhaustive.
+std::optional<KMove> merge(Tour &current_tour, const Tour &candidate_tour, const CombinatorBudget &budget = {});
+// For a candidate derived from current_tour by known moves: only the points touched by those moves
+// (e.g. journaled points) are compared, so finding the differing edges does not scan all n points.
+std::optional<KMove> merge(Tour &current_tour
+    , const Tour &candidate_tour
+    , const std::vector<primitives::point_id_t> &touched_points
+    , const CombinatorBudget &budget = {});
+// Merges given differing edges (from edge_differences).
+std::optional<KMove> merge(Tour &current_tour
+    , const Tour &candidate_tour
+    , const EdgeSet &old_edges
+    , const EdgeSet &new_edges
+    , const CombinatorBudget &budget = {});
 
 }  // namespace merge
@@ -0,0 +1,62 @@
+#pragma once
+
+// Selects how a candidate tour is recombined with the current tour.
+
+#include "combinator.hh"
+#include "gpx.hh"
+#include "kmove.hh"
+#include "merge.hh"
+#include "metrics.hh"
+#include "primitives.hh"
+#include "tour.hh"
+#include "trace_events.hh"
+
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace merge {
+
+enum class Mode {
+    difference_decomposition, // best combination of exchange pairs (merge).
+    partition_crossover // shorter side of each cut-size-2 component (partition_crossover).
+};
+
+inline Mode parse_mode(const std::string &name) {
+    if (name == "dd") {
+        return Mode::difference_decomposition;
+    }
+    if (name == "gpx") {
+        return Mode::partition_crossover;
+    }
+    throw std::invalid_argument("unrecognized merge mode: " + name);
+}
+
+// touched_points (optional): points whose adjacents may differ (see merge.hh).
+// budget only applies to difference decomposition.
+inline std::optional<KMove> recombine(Mode mode
+    , Tour &current_tour
+    , const Tour &candidate_tour
+    , const CombinatorBudget &budget = {}
+    , const std::vector<primitives::point_id_t> *touched_points = nullptr) {
+    TRACE_SCOPE("merge");
+    metrics::ScopedLatency latency(metrics::Latency::merge);
+    metrics::count(metrics::Count::merges_attempted);
+    std::optional<KMove> kmove;
+    if (mode == Mode::partition_crossover) {
+        kmove = touched_points
+            ? partition_crossover(current_tour, candidate_tour, *touched_points)
+            : partition_crossover(current_tour, candidate_tour);
+    } else {
+        kmove = touched_points
+            ? merge(current_tour, candidate_tour, *touched_points, budget)
+            : merge(current_tour, candidate_tour, budget);
+    }
+    if (kmove) {
+        metrics::count(metrics::Count::merges_succeeded);
+    }
+    return kmove;
+}
+
+}  // namespace merge
@@ -0,0 +1,37 @@
+#pragma once
+
+// Process-wide merge telemetry (all threads), replacing per-merge prints.
+
+#include <metrics.hh>
+
+#include <ostream>
+
+namespace merge {
+
+struct Telemetry {
+    metrics::Counter merges; // calls with a non-empty edge difference.
+    metrics::Counter improving_merges;
+    metrics::Counter exhausted_budgets;
+    metrics::Counter double_cycles; // combos that split the tour into two cycles.
+    metrics::Histogram diff_edges; // edges of the current tour that the candidate does not have.
+    metrics::Histogram exchanges; // exchange pairs (dd) or partition components (gpx).
+    metrics::Histogram useless_exchanges;
+    metrics::Histogram combos_checked;
+    metrics::Histogram improvement;
+};
+
+Telemetry &telemetry();
+
+inline std::ostream &operator<<(std::ostream &out, const Telemetry &t) {
+    return out << "merge telemetry: merges " << t.merges.value()
+        << ", improving " << t.improving_merges.value()
+        << ", exhausted budgets " << t.exhausted_budgets.value()
+        << ", double cycles " << t.double_cycles.value()
+        << "; diff edges: " << t.diff_edges
+        << "; exchanges: " << t.exchanges
+        << "; useless exchanges: " << t.useless_exchanges
+        << "; combos checked: " << t.combos_checked
+        << "; improvement: " << t.improvement;
+}
+
+}  // namespace merge
@@ -0,0 +1,137 @@
+#include "metrics.hh"
+
+#include <algorithm> // find
+#include <iomanip> // setprecision
+#include <mutex>
+#include <stdexcept>
+#include <string> // to_string
+#include <vector>
+
+namespace metrics {
+
+const std::array<const char *, COUNTS> COUNT_NAMES{
+    "search_nodes",
+    "neighborhood_candidates",
+    "feasibility_checks",
+    "tour_swaps",
+    "invalidations",
+    "merges_attempted",
+    "merges_succeeded",
+};
+
+const std::array<const char *, LATENCIES> LATENCY_NAMES{
+    "find_best",
+    "swap",
+    "merge",
+};
+
+namespace {
+
+// a zero interval would write lines in a busy loop.
+std::chrono::duration<double> checked_interval(double seconds) {
+    if (not (seconds > 0)) {
+        throw std::invalid_argument("metrics interval must be positive: " + std::to_string(seconds));
+    }
+    return std::chrono::duration<double>(seconds);
+}
+
+std::ofstream open_file(const std::string &path) {
+    std::ofstream file(path, std::ofstream::out | std::ofstream::app);
+    if (not file) {
+        throw std::runtime_error("could not open metrics file: " + path);
+    }
+    return file;
+}
+
+std::mutex registry_mutex;
+std::vector<Shard *> shards; // of running threads.
+Snapshot retired; // of exited threads.
+
+void add(Snapshot &sum, const Shard &shard) {
+    for (size_t c{0}; c < COUNTS; ++c) {
+        sum.counts[c] += shard.counts[c].load(std::memory_order_relaxed);
+    }
+    for (size_t l{0}; l < LATENCIES; ++l) {
+        for (size_t b{0}; b < BUCKETS; ++b) {
+            sum.latency_buckets[l][b] += shard.latency_buckets[l][b].load(std::memory_order_relaxed);
+        }
+        sum.latency_sums[l] += shard.latency_sums[l].load(std::memory_order_relaxed);
+    }
+}
+
+}  // namespace
+
+namespace detail {
+
+std::atomic<bool> timing{false};
+
+void register_shard(Shard *shard) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    shards.push_back(shard);
+}
+
+void retire_shard(Shard *shard) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    add(retired, *shard);
+    shards.erase(std::find(std::begin(shards), std::end(shards), shard));
+}
+
+}  // namespace detail
+
+std::uint64_t Snapshot::latency_count(Latency l) const {
+    std::uint64_t count{0};
+    for (const auto &n : latency_buckets[static_cast<size_t>(l)]) {
+        count += n;
+    }
+    return count;
+}
+
+Snapshot snapshot() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto sum = retired;
+    for (const auto *shard : shards) {
+        add(sum, *shard);
+    }
+    return sum;
+}
+
+void write_json(std::ostream &out, const Snapshot &snapshot, double seconds) {
+    out << "{\"seconds\": " << std::setprecision(6) << seconds << ", \"counts\": {";
+    for (size_t c{0}; c < COUNTS; ++c) {
+        out << (c > 0 ? ", " : "") << '"' << COUNT_NAMES[c] << "\": " << snapshot.counts[c];
+    }
+    out << "}, \"latency_ns\": {";
+    for (size_t l{0}; l < LATENCIES; ++l) {
+        const auto &buckets = snapshot.latency_buckets[l];
+        const auto count = snapshot.latency_count(static_cast<Latency>(l));
+        const double mean = count > 0 ? static_cast<double>(snapshot.latency_sums[l]) / count : 0;
+        out << (l > 0 ? ", " : "") << '"' << LATENCY_NAMES[l] << "\": {"
+            << "\"count\": " << count
+            << ", \"mean\": " << mean
+            << ", \"p50\": " << quantile_bound(buckets, count, 0.5)
+            << ", \"p99\": " << quantile_bound(buckets, count, 0.99)
+            << ", \"max\": " << quantile_bound(buckets, count, 1)
+            << "}";
+    }
+    out << "}}\n";
+}
+
+Reporter::Reporter(const std::string &path, double interval_seconds)
+    : file_(open_file(path))
+    , start_(std::chrono::steady_clock::now())
+    , writer_(checked_interval(interval_seconds), [this] { write(); }) {
+    detail::timing = true;
+}
+
+Reporter::~Reporter() {
+    detail::timing = false;
+    writer_.stop();
+}
+
+void Reporter::write() {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+    write_json(file_, snapshot(), elapsed.count());
+    file_.flush();
+}
+
+}  // namespace metrics
@@ -0,0 +1,206 @@
+#pragma once
+
+// Counters and histograms for telemetry on hot paths: relaxed atomic updates, no I/O.
+// Counter and Histogram are shared by all threads (e.g. merge::Telemetry); the fixed set of solver metrics
+// (Count, Latency) is kept in per-thread shards that only their thread writes (no read-modify-write), summed
+// by snapshot() and dumped periodically as JSON lines by a Reporter.
+
+#include "periodic_writer.hh"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <string>
+
+namespace metrics {
+
+// Power-of-two buckets: bucket 0 counts zeros, bucket b > 0 counts values in [2^(b - 1), 2^b).
+constexpr size_t BUCKETS{65};
+
+inline size_t bucket(std::uint64_t value) {
+    size_t b{0};
+    while (value > 0) {
+        value >>= 1;
+        ++b;
+    }
+    return b;
+}
+
+// Upper bound of the bucket that contains the q-quantile (0 <= q <= 1) of count values.
+template <typename Buckets>
+std::uint64_t quantile_bound(const Buckets &buckets, std::uint64_t count, double q) {
+    std::uint64_t seen{0};
+    for (size_t b{0}; b < BUCKETS; ++b) {
+        seen += buckets[b];
+        if (seen > 0 and seen >= q * count) {
+            return b == 0 ? 0 : (b == BUCKETS - 1 ? UINT64_MAX : (std::uint64_t{1} << b) - 1);
+        }
+    }
+    return 0;
+}
+
+class Counter {
+ public:
+    void add(std::uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+    std::atomic<std::uint64_t> value_{0};
+};
+
+class Histogram {
+ public:
+    void add(std::uint64_t value) {
+        buckets_[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+    }
+    std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    std::uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    double mean() const { return count() > 0 ? static_cast<double>(sum()) / count() : 0; }
+    std::uint64_t quantile_bound(double q) const {
+        std::array<std::uint64_t, BUCKETS> buckets;
+        for (size_t b{0}; b < BUCKETS; ++b) {
+            buckets[b] = buckets_[b].load(std::memory_order_relaxed);
+        }
+        return metrics::quantile_bound(buckets, count(), q);
+    }
+
+ private:
+    std::array<std::atomic<std::uint64_t>, BUCKETS> buckets_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::uint64_t> sum_{0};
+};
+
+// "count mean p50 p99 max" bounds, e.g. for trace lines.
+inline std::ostream &operator<<(std::ostream &out, const Histogram &histogram) {
+    return out << "count " << histogram.count()
+        << " mean " << histogram.mean()
+        << " p50<= " << histogram.quantile_bound(0.5)
+        << " p99<= " << histogram.quantile_bound(0.99)
+        << " max<= " << histogram.quantile_bound(1);
+}
+
+enum class Count : size_t {
+    search_nodes, // HillClimber::try_nearby_points calls.
+    neighborhood_candidates, // points returned by quadtree queries of the climbs.
+    feasibility_checks, // cycle_check::feasible calls of the climbs.
+    tour_swaps, // Tour::swap and Tour::swap_batch calls.
+    invalidations, // search extents reset by HillClimber::changed.
+    merges_attempted, // merge::recombine calls.
+    merges_succeeded, // merge::recombine calls that returned a move.
+    end
+};
+constexpr size_t COUNTS{static_cast<size_t>(Count::end)};
+extern const std::array<const char *, COUNTS> COUNT_NAMES;
+
+enum class Latency : size_t {
+    find_best, // HillClimber::find_best.
+    swap, // Tour::swap and Tour::swap_batch.
+    merge, // merge::recombine.
+    end
+};
+constexpr size_t LATENCIES{static_cast<size_t>(Latency::end)};
+extern const std::array<const char *, LATENCIES> LATENCY_NAMES;
+
+struct Shard {
+    std::array<std::atomic<std::uint64_t>, COUNTS> counts{};
+    std::array<std::array<std::atomic<std::uint64_t>, BUCKETS>, LATENCIES> latency_buckets{}; // nanoseconds.
+    std::array<std::atomic<std::uint64_t>, LATENCIES> latency_sums{};
+};
+
+namespace detail {
+extern std::atomic<bool> timing;
+
+void register_shard(Shard *shard);
+// Adds the shard's values to those of exited threads.
+void retire_shard(Shard *shard);
+
+struct Registration {
+    Shard shard;
+    Registration() { register_shard(&shard); }
+    ~Registration() { retire_shard(&shard); }
+};
+
+inline void increase(std::atomic<std::uint64_t> &value, std::uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+}  // namespace detail
+
+// The calling thread's shard, registered on first use.
+inline Shard &local_shard() {
+    thread_local detail::Registration registration;
+    return registration.shard;
+}
+
+inline void count(Count c, std::uint64_t n = 1) {
+    detail::increase(local_shard().counts[static_cast<size_t>(c)], n);
+}
+
+// Latencies are only measured while a Reporter runs.
+inline bool timing() { return detail::timing.load(std::memory_order_relaxed); }
+
+inline void record(Latency l, std::uint64_t nanoseconds) {
+    auto &shard = local_shard();
+    const auto i = static_cast<size_t>(l);
+    detail::increase(shard.latency_buckets[i][bucket(nanoseconds)], 1);
+    detail::increase(shard.latency_sums[i], nanoseconds);
+}
+
+// Records the latency of its scope.
+class ScopedLatency {
+ public:
+    explicit ScopedLatency(Latency l) : latency_(l), timing_(timing()) {
+        if (timing_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+    ~ScopedLatency() {
+        if (timing_) {
+            record(latency_, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+        }
+    }
+    ScopedLatency(const ScopedLatency &) = delete;
+    ScopedLatency &operator=(const ScopedLatency &) = delete;
+
+ private:
+    const Latency latency_;
+    const bool timing_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Sums of all shards, including those of exited threads.
+struct Snapshot {
+    std::array<std::uint64_t, COUNTS> counts{};
+    std::array<std::array<std::uint64_t, BUCKETS>, LATENCIES> latency_buckets{};
+    std::array<std::uint64_t, LATENCIES> latency_sums{};
+
+    std::uint64_t operator[](Count c) const { return counts[static_cast<size_t>(c)]; }
+    std::uint64_t latency_count(Latency l) const;
+};
+Snapshot snapshot();
+
+// One line: {"seconds": s, "counts": {...}, "latency_ns": {"find_best": {"count", "mean", "p50", "p99", "max"}, ...}};
+// quantiles are bucket upper bounds.
+void write_json(std::ostream &out, const Snapshot &snapshot, double seconds);
+
+// Appends a JSON line to path every interval_seconds (> 0; and when destroyed), and turns on latency timing.
+class Reporter {
+ public:
+    Reporter(const std::string &path, double interval_seconds);
+    ~Reporter();
+    Reporter(const Reporter &) = delete;
+    Reporter &operator=(const Reporter &) = delete;
+
+ private:
+    std::ofstream file_;
+    const std::chrono::steady_clock::time_point start_;
+    PeriodicWriter writer_; // last, so that it starts after the members it uses.
+
+    void write();
+};
+
+}  // namespace metrics
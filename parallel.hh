@@ -0,0 +1,130 @@
+#pragma once
+
+// Multi-start parallel iterated local search.
+// Each worker runs its own kick + climb + merge loop (IteratedLocalSearch) on its own tour and hill climber.
+// Workers run in rounds of sync_interval kicks; between rounds, every worker's tour is merged into the
+// global best (in worker order), and each worker merges the global best back into its own tour at the
+// start of the next round. Each worker draws from its own random stream (randomize::stream(worker + 1)),
+// and merges happen in a fixed order, so runs with the same seed and worker count are reproducible.
+// Worker i always runs on thread i of a persistent pool.
+
+#include "NanoTimer.h"
+#include "hill_climber.hh"
+#include "ils.hh"
+#include "kmove.hh"
+#include "merge/recombine.hh"
+#include "primitives.hh"
+#include "randomize/randomize.hh"
+#include "randomize/xoshiro.hh"
+#include "thread_pool.hh"
+#include "tour.hh"
+
+#include <memory> // unique_ptr
+#include <optional>
+#include <vector>
+
+namespace parallel {
+
+struct WorkerStats {
+    size_t iterations{0}; // kicks that produced a move.
+    size_t pushes{0}; // merges of this worker's tour that improved the global best.
+    size_t pulls{0}; // merges of the global best that improved this worker's tour.
+    double seconds{0}; // time spent in rounds (excluding merges into the global best).
+
+    double iterations_per_second() const { return seconds > 0 ? iterations / seconds : 0; }
+};
+
+template <typename PointSetType>
+class Search {
+ public:
+    // merges into the global best use merge_budget; workers merge serially, with the same node and time limits.
+    // All merges use merge_mode.
+    Search(const BasicHillClimber<PointSetType> &hill_climber
+        , const Tour &tour
+        , size_t kmax
+        , size_t workers
+        , const merge::CombinatorBudget &merge_budget = {}
+        , merge::Mode merge_mode = merge::Mode::difference_decomposition)
+        : global_(tour), merge_budget_(merge_budget), merge_mode_(merge_mode), pool_(workers) {
+        auto worker_budget = merge_budget;
+        worker_budget.threads = 1;
+        for (size_t i{0}; i < workers; ++i) {
+            workers_.push_back({std::make_unique<IteratedLocalSearch<PointSetType>>(hill_climber, tour, kmax, true, worker_budget, merge_mode)
+                , randomize::stream(i + 1)
+                , WorkerStats{}});
+        }
+    }
+
+    const Tour &best() const { return global_; }
+    const Tour &worker_tour(size_t i) const { return workers_[i].search->tour(); }
+    size_t workers() const { return workers_.size(); }
+
+    // Freezes edges in every worker's climbs (see IteratedLocalSearch::freeze).
+    void freeze(const std::vector<typename IteratedLocalSearch<PointSetType>::Edge> &edges) {
+        for (auto &worker : workers_) {
+            worker.search->freeze(edges);
+        }
+    }
+    std::vector<WorkerStats> stats() const {
+        std::vector<WorkerStats> stats;
+        for (const auto &worker : workers_) {
+            stats.push_back(worker.stats);
+        }
+        return stats;
+    }
+
+    // Merges a tour from outside (e.g. an island migrant) into the global best; returns true if it improved.
+    bool import(const Tour &tour) {
+        return merge::recombine(merge_mode_, global_, tour, merge_budget_).has_value();
+    }
+
+    // Runs one round of sync_interval kicks per worker, then merges workers into the global best.
+    // make_kick(tour) returns an optional KMove (see perturb.hh); it is called concurrently by all workers.
+    // Returns true if the global best improved.
+    template <typename MakeKick>
+    bool round(size_t sync_interval, const MakeKick &make_kick) {
+        pool_.run([this, sync_interval, &make_kick](size_t t) {
+            auto &worker = workers_[t];
+            NanoTimer timer;
+            timer.start();
+            randomize::generator() = worker.generator;
+            if (rounds_ > 0 and worker.search->merge_from(global_)) {
+                ++worker.stats.pulls;
+            }
+            for (size_t i{0}; i < sync_interval; ++i) {
+                const auto kick = make_kick(worker.search->tour());
+                if (kick) {
+                    worker.search->step(*kick);
+                    ++worker.stats.iterations;
+                }
+            }
+            worker.generator = randomize::generator();
+            worker.stats.seconds += timer.stop() / 1e9;
+        });
+        ++rounds_;
+        bool improved{false};
+        for (auto &worker : workers_) {
+            if (merge::recombine(merge_mode_, global_, worker.search->tour(), merge_budget_)) {
+                ++worker.stats.pushes;
+                improved = true;
+            }
+        }
+        return improved;
+    }
+
+ private:
+    struct Worker {
+        // not movable (journals), so held by pointer.
+        std::unique_ptr<IteratedLocalSearch<PointSetType>> search;
+        randomize::Xoshiro256ss generator;
+        WorkerStats stats;
+    };
+    Tour global_;
+    const merge::CombinatorBudget merge_budget_;
+    const merge::Mode merge_mode_;
+    std::vector<Worker> workers_;
+    size_t rounds_{0};
+    ThreadPool pool_; // last, so that its threads stop before the workers are destroyed.
+};
+
+}  // namespace parallel
@@ -0,0 +1,82 @@
+#pragma once
+
+// Divide-and-conquer optimization for instances too large for global iterated local search.
+// Each round cuts the tour into parts of consecutive tour points (at a random offset, so that the
+// boundaries move between rounds) and optimizes every part independently and in parallel as a
+// sub-instance with fixed endpoints (segment::optimize). The improving moves touch disjoint edges,
+// so they are applied together with a single Tour::swap_batch.
+// Parts of a good tour (or of a space-filling curve tour) are spatially compact strips; unlike
+// the points of a quadtree box, each part is a single path, so fixing its endpoints keeps the tour valid.
+
+#include "kmove.hh"
+#include "primitives.hh"
+#include "randomize/randomize.hh"
+#include "randomize/xoshiro.hh"
+#include "segment.hh"
+#include "thread_pool.hh"
+#include "tour.hh"
+#include "trace_events.hh"
+
+#include <algorithm> // min
+#include <optional>
+#include <vector>
+
+namespace partition {
+
+template <typename Storage>
+class Partitioner {
+ public:
+    // parts: number of parts per round (K); threads: parts are optimized by this many threads.
+    // kmax: climb; kick_kmax and kicks: kswap kicks per part.
+    Partitioner(size_t parts, size_t threads, size_t kmax, size_t kick_kmax, size_t kicks)
+        : parts_(parts), kmax_(kmax), kick_kmax_(kick_kmax), kicks_(kicks), pool_(threads) {
+        for (size_t i{0}; i < threads; ++i) {
+            generators_.push_back(randomize::stream(i + 1));
+        }
+    }
+
+    // Optimizes every part of the tour once; returns the applied (improving) moves.
+    std::vector<KMove> round(Tour &tour) {
+        const primitives::point_id_t n = tour.size();
+        const primitives::point_id_t part_length = (n + parts_ - 1) / parts_;
+        const auto offset = randomize::random_point(0, n - 1);
+        std::vector<primitives::point_id_t> starts;
+        for (primitives::point_id_t s{0}; s < n; s += part_length) {
+            starts.push_back(tour.order()[(offset + s) % n]);
+        }
+
+        std::vector<std::optional<KMove>> kmoves(starts.size());
+        pool_.run([this, &tour, &starts, &kmoves, part_length, n](size_t t) {
+            randomize::generator() = generators_[t];
+            for (size_t i{t}; i < starts.size(); i += generators_.size()) {
+                // the last part ends where the first part starts.
+                const auto length = std::min<primitives::point_id_t>(part_length, n - i * part_length);
+                TRACE_SCOPE("part");
+                kmoves[i] = segment::optimize<Storage>(tour, starts[i], length, kmax_, kick_kmax_, kicks_);
+            }
+            generators_[t] = randomize::generator();
+        });
+
+        std::vector<KMove> applied;
+        for (auto &kmove : kmoves) {
+            if (kmove) {
+                applied.push_back(std::move(*kmove));
+            }
+        }
+        if (not applied.empty()) {
+            TRACE_SCOPE("perturb");
+            tour.swap_batch(applied);
+        }
+        return applied;
+    }
+
+ private:
+    const size_t parts_;
+    const size_t kmax_;
+    const size_t kick_kmax_;
+    const size_t kicks_;
+    std::vector<randomize::Xoshiro256ss> generators_; // one per thread, so that runs are reproducible.
+    parallel::ThreadPool pool_;
+};
+
+}  // namespace partition
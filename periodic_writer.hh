@@ -0,0 +1,65 @@
+#pragma once
+
+// Background thread for the trace sink, trace event writer and metrics reporter: calls a flush function
+// at least every interval, when woken, and a last time when stopped, so that the threads producing the
+// data never do file I/O.
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility> // move
+
+class PeriodicWriter {
+ public:
+    // flush only runs on the background thread, one call at a time.
+    PeriodicWriter(std::chrono::duration<double> interval, std::function<void()> flush)
+        : interval_(interval), flush_(std::move(flush)), thread_([this] { run(); }) {}
+    ~PeriodicWriter() { stop(); }
+    PeriodicWriter(const PeriodicWriter &) = delete;
+    PeriodicWriter &operator=(const PeriodicWriter &) = delete;
+
+    // Flushes without waiting for the rest of the interval.
+    void wake() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            woken_ = true;
+        }
+        wake_.notify_one();
+    }
+
+    // Flushes a last time and joins the background thread; later calls do nothing.
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+ private:
+    const std::chrono::duration<double> interval_;
+    const std::function<void()> flush_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool woken_{false};
+    bool stopping_{false};
+    std::thread thread_; // last, so that it starts after the members it uses.
+
+    void run() {
+        bool stopping{false};
+        while (not stopping) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait_for(lock, interval_, [this] { return stopping_ or woken_; });
+                woken_ = false;
+                stopping = stopping_;
+            }
+            flush_();
+        }
+    }
+};
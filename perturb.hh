@@ -1,5 +1,6 @@
 #pragma once
 
+#include "edge.hh"
 #include "hill_climb.hh"
 #include "hill_climber.hh"
 #include "kmove.hh"
@@ -8,28 +9,39 @@
 #include "randomize/double_bridge.h"
 #include "randomize/randomize.hh"
 #include "tour.hh"
+#include "trace_events.hh"
 #include "multicycle_tour.hh"
 #include "point_quadtree/Domain.h"
 
+#include <algorithm> // any_of, sort
 #include <optional>
 #include <vector>
 #include <iterator>
 
 namespace perturb {
 
-inline Tour perturb(const PointSet &point_set, const Tour &tour, size_t kmax) {
+template <typename Storage>
+Tour perturb(const BasicPointSet<Storage> &point_set, const Tour &tour, size_t kmax) {
     auto new_tour = tour;
     randomize::double_bridge::swap(new_tour);
     hill_climb::hill_climb(point_set, new_tour, kmax);
     return new_tour;
 }
 
-inline Tour perturb(const HillClimber &hill_climber, const Tour &tour, size_t kmax) {
+// The *_in_place variants perturb and climb tour and hill_climber directly, e.g. to be restored
+// through a Journal afterwards, instead of working on copies.
+
+template <typename PointSetType>
+void perturb_in_place(BasicHillClimber<PointSetType> &hill_climber, Tour &tour, size_t kmax) {
+    const auto kmove = randomize::double_bridge::swap(tour);
+    hill_climber.changed(kmove);
+    hill_climb::hill_climb(hill_climber, tour, kmax);
+}
+template <typename PointSetType>
+Tour perturb(const BasicHillClimber<PointSetType> &hill_climber, const Tour &tour, size_t kmax) {
     auto new_hill_climber = hill_climber;
     auto new_tour = tour;
-    const auto kmove = randomize::double_bridge::swap(new_tour);
-    new_hill_climber.changed(kmove);
-    hill_climb::hill_climb(new_hill_climber, new_tour, kmax);
+    perturb_in_place(new_hill_climber, new_tour, kmax);
     return new_tour;
 }
 
@@ -50,16 +62,38 @@ inline KMove dense_kswap(const std::vector<primitives::point_id_t> &ordered_poin
     }
     return kmove;
 }
-inline Tour dense_kswap(const HillClimber &hill_climber, const Tour &tour, size_t kmax, size_t swap_kmax) {
+template <typename PointSetType>
+void dense_kswap_in_place(BasicHillClimber<PointSetType> &hill_climber, Tour &tour, size_t kmax, size_t swap_kmax) {
+    const auto kmove = dense_kswap(tour.order(), randomize::sequence(tour.size()), swap_kmax);
+    tour.swap(kmove);
+    hill_climber.changed(kmove);
+    hill_climb::hill_climb(hill_climber, tour, kmax);
+}
+template <typename PointSetType>
+Tour dense_kswap(const BasicHillClimber<PointSetType> &hill_climber, const Tour &tour, size_t kmax, size_t swap_kmax) {
     auto new_hill_climber = hill_climber;
     auto new_tour = tour;
-    const auto kmove = dense_kswap(new_tour.order(), randomize::sequence(new_tour.size()), swap_kmax);
-    new_tour.swap(kmove);
-    new_hill_climber.changed(kmove);
-    hill_climb::hill_climb(new_hill_climber, new_tour, kmax);
+    dense_kswap_in_place(new_hill_climber, new_tour, kmax, swap_kmax);
     return new_tour;
 }
 
+// k-swap on the edges starting at the given sequence ids.
+// sequence_ids must be in tour order (ascending, up to rotation), and no two may be adjacent.
+inline KMove kswap(const std::vector<primitives::point_id_t> &ordered_points, const std::vector<primitives::sequence_t> &sequence_ids)
+{
+    const auto &n = ordered_points.size();
+    const auto &kmax = sequence_ids.size();
+    KMove kmove;
+    for (size_t k{0}; k < kmax; ++k) {
+        const auto &s = sequence_ids[k];
+        kmove.removes.push_back(ordered_points[s]);
+        kmove.starts.push_back(ordered_points[(s + 1) % n]);
+        const auto &s_end = sequence_ids[(k + 2) % kmax];
+        kmove.ends.push_back(ordered_points[s_end]);
+    }
+    return kmove;
+}
+
 // k-swap perturbation that selects completely random edges.
 // kmax == 4: double-bridge.
 inline KMove kswap(const std::vector<primitives::point_id_t> &ordered_points, size_t start, size_t kmax)
@@ -70,34 +104,151 @@ inline KMove kswap(const std::vector<primitives::point_id_t> &ordered_points, si
     primitives::sequence_t shift{0};
     std::transform(std::begin(sequence_ids), std::end(sequence_ids), std::begin(sequence_ids),
         [&start, &shift, &n](const auto &i) { return (start + i + shift++) % n; });
-    KMove kmove;
+    return kswap(ordered_points, sequence_ids);
+}
+
+// Local kicks: k-swaps whose removed edges are all near each other, so that the climb only repairs
+// a small region instead of undoing long-range reconnections.
+
+// Selects kmax edges (by their start points) from candidates, in candidate order, skipping edges adjacent
+// to an already selected edge. Returns their sequence ids in tour order, or nothing if fewer than kmax qualify.
+inline std::optional<std::vector<primitives::sequence_t>> spaced_sequences(const Tour &tour
+    , const std::vector<primitives::point_id_t> &candidates
+    , size_t kmax)
+{
+    const primitives::sequence_t n = tour.size();
+    const auto origin = tour.order().front();
+    std::vector<primitives::sequence_t> selected;
+    for (const auto &p : candidates) {
+        const auto s = tour.sequence(p, origin);
+        const bool adjacent = std::any_of(std::cbegin(selected), std::cend(selected), [s, n](auto t) {
+            const auto gap = (s > t) ? s - t : t - s;
+            return gap < 2 or n - gap < 2;
+        });
+        if (not adjacent) {
+            selected.push_back(s);
+            if (selected.size() == kmax) {
+                std::sort(std::begin(selected), std::end(selected));
+                return selected;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+// k-swap on random edges starting within a square (of size 2 * radius) around a random point.
+// kmax == 4: local double-bridge.
+template <typename PointSetType>
+std::optional<KMove> local_kswap(const PointSetType &point_set, const Tour &tour, size_t kmax, primitives::length_t radius)
+{
+    const auto center = randomize::random_point(0, tour.size() - 1);
+    auto candidates = point_set.get_points(center, radius);
+    randomize::shuffle(std::begin(candidates), std::end(candidates));
+    const auto sequence_ids = spaced_sequences(tour, candidates, kmax);
+    if (not sequence_ids) {
+        return std::nullopt;
+    }
+    return kswap(tour.order(), *sequence_ids);
+}
+
+// k-swap on edges along a random walk forward in the tour from start, with steps of 2 to (2 + max_step) edges.
+// std::nullopt if the tour is too short for kmax steps of 2 (fewer than 2 * kmax + 1 points).
+inline std::optional<KMove> walk_kswap(const std::vector<primitives::point_id_t> &ordered_points, size_t start, size_t kmax, size_t max_step)
+{
+    const auto &n = ordered_points.size();
+    // the walk must not wrap around to the first edge.
+    const auto max_stride = (n - 1) / kmax;
+    if (max_stride < 2) {
+        return std::nullopt;
+    }
+    max_step = std::min(max_step, max_stride - 2);
+    std::vector<primitives::sequence_t> sequence_ids;
+    auto s = start;
     for (size_t k{0}; k < kmax; ++k) {
-        const auto &s = sequence_ids[k];
-        kmove.removes.push_back(ordered_points[s]);
-        kmove.starts.push_back(ordered_points[(s + 1) % n]);
-        const auto &s_end = sequence_ids[(k + 2) % kmax];
-        kmove.ends.push_back(ordered_points[s_end]);
+        sequence_ids.push_back(s % n);
+        s += 2 + randomize::random_point(0, max_step);
     }
-    return kmove;
+    return kswap(ordered_points, sequence_ids);
 }
-inline Tour kswap(const HillClimber &hill_climber, const Tour &tour, size_t kmax, size_t swap_kmax) {
+
+// k-swap seeded by a random short (non-tour) edge, e.g. from two_short::get_short_edges:
+// removes the edges starting at both of its points, and random edges near its first point.
+template <typename PointSetType>
+std::optional<KMove> close_pair_kswap(const PointSetType &point_set
+    , const Tour &tour
+    , const std::vector<edge::Edge> &short_edges
+    , size_t kmax
+    , primitives::length_t radius)
+{
+    if (short_edges.empty()) {
+        return std::nullopt;
+    }
+    const auto &pair = short_edges[randomize::random_point(0, short_edges.size() - 1)];
+    auto nearby = point_set.get_points(pair.first, radius);
+    randomize::shuffle(std::begin(nearby), std::end(nearby));
+    std::vector<primitives::point_id_t> candidates{pair.first, pair.second};
+    candidates.insert(std::end(candidates), std::cbegin(nearby), std::cend(nearby));
+    const auto sequence_ids = spaced_sequences(tour, candidates, kmax);
+    if (not sequence_ids) {
+        return std::nullopt;
+    }
+    return kswap(tour.order(), *sequence_ids);
+}
+
+// Acceptance rate and improvement rate of a kick, over a series of kick + climb + merge iterations.
+struct KickStats {
+    size_t kicks{0};
+    size_t accepted{0}; // iterations that shortened the tour.
+    primitives::length_t improvement{0};
+    double cpu_seconds{0};
+
+    void add(primitives::length_t old_length, primitives::length_t new_length, double seconds) {
+        ++kicks;
+        if (new_length < old_length) {
+            ++accepted;
+            improvement += old_length - new_length;
+        }
+        cpu_seconds += seconds;
+    }
+    double acceptance_rate() const { return kicks > 0 ? static_cast<double>(accepted) / kicks : 0; }
+    double improvement_per_cpu_second() const { return cpu_seconds > 0 ? improvement / cpu_seconds : 0; }
+};
+
+template <typename PointSetType>
+void kick_in_place(BasicHillClimber<PointSetType> &hill_climber, Tour &tour, size_t kmax, const KMove &kick) {
+    {
+        TRACE_SCOPE("perturb");
+        tour.swap(kick);
+        hill_climber.changed(kick);
+    }
+    TRACE_SCOPE("climb");
+    hill_climb::hill_climb(hill_climber, tour, kmax);
+}
+
+template <typename PointSetType>
+void kswap_in_place(BasicHillClimber<PointSetType> &hill_climber, Tour &tour, size_t kmax, size_t swap_kmax) {
+    const auto kmove = kswap(tour.order(), randomize::sequence(tour.size()), swap_kmax);
+    tour.swap(kmove);
+    hill_climber.changed(kmove);
+    hill_climb::hill_climb(hill_climber, tour, kmax);
+}
+template <typename PointSetType>
+Tour kswap(const BasicHillClimber<PointSetType> &hill_climber, const Tour &tour, size_t kmax, size_t swap_kmax) {
     auto new_hill_climber = hill_climber;
     auto new_tour = tour;
-    const auto kmove = kswap(new_tour.order(), randomize::sequence(new_tour.size()), swap_kmax);
-    new_tour.swap(kmove);
-    new_hill_climber.changed(kmove);
-    hill_climb::hill_climb(new_hill_climber, new_tour, kmax);
+    kswap_in_place(new_hill_climber, new_tour, kmax, swap_kmax);
     return new_tour;
 }
 
-inline Tour random_restart(const PointSet &point_set, const point_quadtree::Domain *domain, size_t kmax) {
-    HillClimber hill_climber(point_set);
+template <typename Storage>
+Tour random_restart(const BasicPointSet<Storage> &point_set, const point_quadtree::Domain *domain, size_t kmax) {
+    BasicHillClimber<BasicPointSet<Storage>> hill_climber(point_set);
     const auto &n = domain->x().size();
     std::vector<primitives::point_id_t> random_order(n);
     for (primitives::point_id_t i{0}; i < n; ++i) {
         random_order[i] = i;
     }
-    std::random_shuffle(std::begin(random_order), std::end(random_order));
+    randomize::shuffle(std::begin(random_order), std::end(random_order));
     Tour tour(domain, random_order);
     hill_climb::hill_climb(hill_climber, tour, kmax);
     return tour;
@@ -114,7 +265,7 @@ inline KMove random_section(const std::vector<primitives::point_id_t> &ordered_p
     }
     // first and last point in randomized sequence will not be shuffled,
     // but connected edges will still be deleted.
-    std::random_shuffle(std::next(std::begin(random_order)), std::prev(std::end(random_order)));
+    randomize::shuffle(std::next(std::begin(random_order)), std::prev(std::end(random_order)));
 
     KMove kmove;
     for (auto it = std::cbegin(random_order); it != std::prev(std::cend(random_order)); ++it) {
@@ -127,13 +278,18 @@ inline KMove random_section(const std::vector<primitives::point_id_t> &ordered_p
     return kmove;
 }
 
-inline Tour random_section(const HillClimber &hill_climber, const Tour &tour, size_t kmax, double random_fraction) {
+template <typename PointSetType>
+void random_section_in_place(BasicHillClimber<PointSetType> &hill_climber, Tour &tour, size_t kmax, double random_fraction) {
+    const auto kmove = random_section(tour.order(), randomize::sequence(tour.size()), random_fraction);
+    tour.swap(kmove);
+    hill_climber.changed(kmove);
+    hill_climb::hill_climb(hill_climber, tour, kmax);
+}
+template <typename PointSetType>
+Tour random_section(const BasicHillClimber<PointSetType> &hill_climber, const Tour &tour, size_t kmax, double random_fraction) {
     auto new_hill_climber = hill_climber;
     auto new_tour = tour;
-    const auto kmove = random_section(new_tour.order(), randomize::sequence(new_tour.size()), random_fraction);
-    new_tour.swap(kmove);
-    new_hill_climber.changed(kmove);
-    hill_climb::hill_climb(new_hill_climber, new_tour, kmax);
+    random_section_in_place(new_hill_climber, new_tour, kmax, random_fraction);
     return new_tour;
 }
 
@@ -143,7 +299,7 @@ inline std::vector<primitives::point_id_t> one_edge_per_cycle(const MulticycleTo
     for (auto &p : points) {
         p = i++;
     }
-    std::random_shuffle(std::begin(points), std::end(points));
+    randomize::shuffle(std::begin(points), std::end(points));
     std::vector<primitives::point_id_t> selections(tour.cycles(), constants::INVALID_POINT);
     size_t selected{0};
     for (const auto &p : points) {
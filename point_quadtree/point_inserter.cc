@@ -8,7 +8,8 @@ void PointInserter::place()
     {
         descend();
     }
-    if (m_current_node->empty() or m_current_depth == constants::max_tree_depth)
+    // deepest nodes (depth max_tree_depth - 1) can hold multiple points.
+    if (m_current_node->empty() or m_current_depth == constants::max_tree_depth - 1)
     {
         m_current_node->insert(m_point);
         return;
@@ -79,11 +79,11 @@ void validate(const Node& node, primitives::depth_t depth)
     {
         throw std::logic_error("non-leaf node is not empty!");
     }
-    if (depth != constants::max_tree_depth and node.size() > 1)
+    if (depth != constants::max_tree_depth - 1 and node.size() > 1)
     {
         throw std::logic_error("found non-max-depth node with more than 1 point!");
     }
-    if (depth > constants::max_tree_depth)
+    if (depth > constants::max_tree_depth - 1)
     {
         throw std::logic_error("max tree depth exceeded!");
     }
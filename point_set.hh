@@ -1,29 +1,45 @@
 #pragma once
 
 // Represents a TSP instance (not any particular tour, though).
+// Storage is a coordinate storage policy; see point_storage.hh.
 
 #include <vector>
 
-#include "length_calculator.hh"
-#include "box_maker.hh"
+#include "box.hh"
+#include "point_storage.hh"
 #include "primitives.hh"
 #include "point_quadtree/node.hh"
 
-class PointSet {
+template <typename Storage = point_storage::Soa>
+class BasicPointSet {
  public:
-    PointSet(const point_quadtree::Node& root,
+    using StorageType = Storage;
+
+    BasicPointSet(const point_quadtree::Node& root,
         const std::vector<primitives::space_t> &x,
         const std::vector<primitives::space_t> &y)
-        : m_root(root), m_box_maker(x, y), size_(x.size()), m_length_calculator(x, y) {}
+        : m_root(root), size_(x.size()), m_storage(x, y) {}
 
     primitives::length_t length(primitives::point_id_t a, primitives::point_id_t b) const {
-        return m_length_calculator(a, b);
+        return m_storage.length(a, b);
+    }
+    // lengths[i] = length(a, points[i]).
+    void lengths(primitives::point_id_t a,
+        const std::vector<primitives::point_id_t> &points,
+        std::vector<primitives::length_t> &lengths) const {
+        m_storage.lengths(a, points, lengths);
+    }
+    // Only for Storage::INTEGRAL. squared_lengths[i] is the exact squared length from a to points[i].
+    void squared_lengths(primitives::point_id_t a,
+        const std::vector<primitives::point_id_t> &points,
+        std::vector<primitives::squared_length_t> &squared_lengths) const {
+        m_storage.squared_lengths(a, points, squared_lengths);
     }
 
     // Returns points within square (of size 2 * radius) centered at point i.
     inline std::vector<primitives::point_id_t> get_points(primitives::point_id_t i,
         primitives::length_t radius) const {
-        return m_root.get_points(i, m_box_maker(i, radius));
+        return m_root.get_points(i, get_box(i, radius));
     }
     // Returns points within square (of size 2 * radius) centered at point i.
     inline std::vector<primitives::point_id_t> get_points(primitives::point_id_t i, const Box &box) const {
@@ -31,7 +47,12 @@ class PointSet {
     }
 
     inline Box get_box(primitives::point_id_t i, primitives::length_t radius) const {
-        return m_box_maker(i, radius);
+        Box box;
+        box.xmin = m_storage.x(i) - radius;
+        box.xmax = m_storage.x(i) + radius;
+        box.ymin = m_storage.y(i) - radius;
+        box.ymax = m_storage.y(i) + radius;
+        return box;
     }
 
     inline primitives::point_id_t size() const {
@@ -40,9 +61,9 @@ class PointSet {
 
  private:
     const point_quadtree::Node& m_root;
-    const BoxMaker m_box_maker;
     const primitives::point_id_t size_{0};
-    LengthCalculator m_length_calculator;
+    const Storage m_storage;
 
 };
 
+using PointSet = BasicPointSet<>;
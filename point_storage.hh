@@ -0,0 +1,156 @@
+#pragma once
+
+// Coordinate storage policies for PointSet.
+// Each policy provides coordinates and rounded lengths (identical to LengthCalculator) for its layout:
+//  Soa: separate x and y arrays (the layout read from file).
+//  Packed: one {x, y} record per point, so that both coordinates share a cache line.
+//  Float: packed float32 records; half the memory of Packed.
+//  Quantized: packed int32 records; half the memory of Packed.
+// Float and Quantized are only exact for some instances; see allows().
+// INTEGRAL policies additionally provide exact squared lengths, so that candidates can be rejected without sqrt.
+
+#include "length_calculator.hh"
+#include "length_kernel.hh"
+#include "primitives.hh"
+
+#include <algorithm> // all_of
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace point_storage {
+
+class Soa {
+ public:
+    static constexpr const char *NAME{"soa"};
+    static constexpr bool INTEGRAL{false};
+    static bool allows(const std::vector<primitives::space_t> &, const std::vector<primitives::space_t> &) { return true; }
+
+    Soa(const std::vector<primitives::space_t> &x, const std::vector<primitives::space_t> &y)
+        : length_calculator_(x, y) {}
+
+    primitives::space_t x(primitives::point_id_t i) const { return length_calculator_.x(i); }
+    primitives::space_t y(primitives::point_id_t i) const { return length_calculator_.y(i); }
+
+    primitives::length_t length(primitives::point_id_t a, primitives::point_id_t b) const {
+        return length_calculator_(a, b);
+    }
+    void lengths(primitives::point_id_t a
+        , const std::vector<primitives::point_id_t> &points
+        , std::vector<primitives::length_t> &lengths) const {
+        length_calculator_(a, points, lengths);
+    }
+
+ private:
+    LengthCalculator length_calculator_;
+};
+
+namespace detail {
+
+inline primitives::length_t round_length(double dx, double dy) {
+    auto exact = std::sqrt(dx * dx + dy * dy);
+    return exact + 0.5; // return type cast.
+}
+
+// Stores coordinates as interleaved records of type T.
+// Coordinates are converted back to double before subtraction, so results match the double
+// computation whenever every coordinate is exactly representable in T.
+template <typename T>
+class PackedBase {
+ public:
+    PackedBase(const std::vector<primitives::space_t> &x, const std::vector<primitives::space_t> &y)
+        : points_(x.size()) {
+        for (size_t i{0}; i < x.size(); ++i) {
+            points_[i] = {static_cast<T>(x[i]), static_cast<T>(y[i])};
+        }
+    }
+
+    primitives::space_t x(primitives::point_id_t i) const { return points_[i].x; }
+    primitives::space_t y(primitives::point_id_t i) const { return points_[i].y; }
+
+    primitives::length_t length(primitives::point_id_t a, primitives::point_id_t b) const {
+        const auto &pa = points_[a];
+        const auto &pb = points_[b];
+        return round_length(static_cast<double>(pa.x) - pb.x, static_cast<double>(pa.y) - pb.y);
+    }
+    void lengths(primitives::point_id_t a
+        , const std::vector<primitives::point_id_t> &points
+        , std::vector<primitives::length_t> &lengths) const {
+        lengths.resize(points.size());
+        for (size_t i{0}; i < points.size(); ++i) {
+            lengths[i] = length(a, points[i]);
+        }
+    }
+
+ protected:
+    struct Point {
+        T x;
+        T y;
+    };
+    std::vector<Point> points_;
+};
+
+}  // namespace detail
+
+class Packed : public detail::PackedBase<primitives::space_t> {
+ public:
+    static constexpr const char *NAME{"packed"};
+    static constexpr bool INTEGRAL{false};
+    static bool allows(const std::vector<primitives::space_t> &, const std::vector<primitives::space_t> &) { return true; }
+
+    using PackedBase::PackedBase;
+
+    // interleaved doubles can still use the vectorized kernel with a stride of 2.
+    void lengths(primitives::point_id_t a
+        , const std::vector<primitives::point_id_t> &points
+        , std::vector<primitives::length_t> &lengths) const {
+        lengths.resize(points.size());
+        constexpr size_t stride{2};
+        length_kernel::lengths(x(a), y(a), &points_.front().x, &points_.front().y, stride
+            , points.data(), points.size(), lengths.data());
+    }
+};
+
+class Float : public detail::PackedBase<float> {
+ public:
+    static constexpr const char *NAME{"float"};
+    static constexpr bool INTEGRAL{false};
+    // every coordinate must be exactly representable as float.
+    static bool allows(const std::vector<primitives::space_t> &x, const std::vector<primitives::space_t> &y) {
+        const auto exact = [](auto c) { return static_cast<primitives::space_t>(static_cast<float>(c)) == c; };
+        return std::all_of(std::cbegin(x), std::cend(x), exact) and std::all_of(std::cbegin(y), std::cend(y), exact);
+    }
+
+    using PackedBase::PackedBase;
+};
+
+class Quantized : public detail::PackedBase<int32_t> {
+ public:
+    static constexpr const char *NAME{"quantized"};
+    static constexpr bool INTEGRAL{true};
+    // every coordinate must be integral, and small enough that squared distances are exact in double.
+    static bool allows(const std::vector<primitives::space_t> &x, const std::vector<primitives::space_t> &y) {
+        const auto exact = [](auto c) { return std::trunc(c) == c and std::abs(c) <= (1 << 25); };
+        return std::all_of(std::cbegin(x), std::cend(x), exact) and std::all_of(std::cbegin(y), std::cend(y), exact);
+    }
+
+    using PackedBase::PackedBase;
+
+    primitives::squared_length_t squared_length(primitives::point_id_t a, primitives::point_id_t b) const {
+        const auto &pa = points_[a];
+        const auto &pb = points_[b];
+        const int64_t dx = static_cast<int64_t>(pa.x) - pb.x;
+        const int64_t dy = static_cast<int64_t>(pa.y) - pb.y;
+        return dx * dx + dy * dy;
+    }
+    void squared_lengths(primitives::point_id_t a
+        , const std::vector<primitives::point_id_t> &points
+        , std::vector<primitives::squared_length_t> &squared_lengths) const {
+        squared_lengths.resize(points.size());
+        for (size_t i{0}; i < points.size(); ++i) {
+            squared_lengths[i] = squared_length(a, points[i]);
+        }
+    }
+};
+
+}  // namespace point_storage
@@ -0,0 +1,117 @@
+#pragma once
+
+// Bounded pool of elite tours (local optima), shortest first.
+// Each tour is stored as its successor array (one point id per point: 4 MB per tour at 1M points),
+// which answers "does the tour contain edge (a, b)" in O(1) and rebuilds a Tour in O(n) when needed.
+// A shared edge frequency table counts, for each edge (p, next(p)) of the shortest tour, the members
+// that contain it; edges contained in every member of a full pool are the pool's common edges, which
+// a search can freeze (see IteratedLocalSearch::freeze) to focus on the contested parts of the tour.
+
+#include "point_quadtree/Domain.h"
+#include "primitives.hh"
+#include "tour.hh"
+
+#include <algorithm> // upper_bound
+#include <cstdint>
+#include <utility> // pair
+#include <vector>
+
+namespace pool {
+
+class TourPool {
+ public:
+    using Edge = std::pair<primitives::point_id_t, primitives::point_id_t>;
+
+    TourPool(const point_quadtree::Domain *domain, size_t capacity) : domain_(domain), capacity_(capacity) {}
+
+    size_t size() const { return members_.size(); }
+    bool full() const { return members_.size() == capacity_; }
+    primitives::length_t length(size_t i) const { return members_[i].length; }
+
+    // Adds tour if the pool is not full or tour is shorter than the longest member (which it then replaces),
+    // and no member has the same edges. Returns true if tour was added.
+    bool offer(const Tour &tour) {
+        const auto length = tour.length();
+        if (full() and length >= members_.back().length) {
+            return false;
+        }
+        for (const auto &member : members_) {
+            if (member.length == length and same_edges(member, tour)) {
+                return false;
+            }
+        }
+        if (full()) {
+            members_.pop_back();
+        }
+        const auto position = std::upper_bound(std::cbegin(members_), std::cend(members_), length
+            , [](auto length, const auto &member) { return length < member.length; });
+        members_.insert(position, {tour.next(), length});
+        count_edges();
+        return true;
+    }
+
+    // Rebuilds member i (0: shortest).
+    Tour tour(size_t i) const {
+        const auto &next = members_[i].next;
+        std::vector<primitives::point_id_t> order;
+        order.reserve(next.size());
+        primitives::point_id_t p{0};
+        do {
+            order.push_back(p);
+            p = next[p];
+        } while (p != 0);
+        return Tour(domain_, order);
+    }
+
+    // Edges contained in every member; empty unless the pool is full.
+    std::vector<Edge> common_edges() const {
+        std::vector<Edge> common;
+        if (not full()) {
+            return common;
+        }
+        const auto &next = members_.front().next;
+        for (primitives::point_id_t p{0}; p < next.size(); ++p) {
+            if (frequency_[p] == members_.size()) {
+                common.emplace_back(p, next[p]);
+            }
+        }
+        return common;
+    }
+
+ private:
+    struct Member {
+        std::vector<primitives::point_id_t> next;
+        primitives::length_t length;
+    };
+
+    const point_quadtree::Domain *domain_;
+    const size_t capacity_;
+    std::vector<Member> members_; // shortest first.
+    // frequency_[p]: number of members that contain edge (p, next(p)) of the shortest member.
+    std::vector<std::uint16_t> frequency_;
+
+    static bool contains(const Member &member, primitives::point_id_t a, primitives::point_id_t b) {
+        return member.next[a] == b or member.next[b] == a;
+    }
+
+    static bool same_edges(const Member &member, const Tour &tour) {
+        for (primitives::point_id_t p{0}; p < tour.size(); ++p) {
+            if (not contains(member, p, tour.next(p))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void count_edges() {
+        const auto &next = members_.front().next;
+        frequency_.assign(next.size(), 0);
+        for (const auto &member : members_) {
+            for (primitives::point_id_t p{0}; p < next.size(); ++p) {
+                frequency_[p] += contains(member, p, next[p]);
+            }
+        }
+    }
+};
+
+}  // namespace pool
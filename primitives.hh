@@ -8,6 +8,7 @@
 namespace primitives {
 
 using length_t = uint64_t; // as in segment or tour lengths.
+using squared_length_t = uint64_t; // exact squared lengths between integral coordinates.
 using point_id_t = uint32_t;
 using sequence_t = uint32_t;
 using space_t = double; // as in x, y coordinates.
@@ -1,41 +1,94 @@
 #pragma once
 
+#include "xoshiro.hh"
+
+#include <algorithm> // lower_bound, shuffle
+#include <atomic>
+#include <cstdint>
 #include <random>
+#include <vector>
 #include <primitives.hh>
 
 namespace randomize {
 
+// Every random choice (perturbations, kicks, shuffles) draws from the calling thread's generator,
+// which is stream 0 of the run seed unless the thread selects another stream with use_stream.
+// Runs with the same seed and the same stream per thread are therefore reproducible.
+
+namespace detail {
+
+inline std::atomic<std::uint64_t> &run_seed() {
+    static std::atomic<std::uint64_t> seed{std::random_device{}() ^ (static_cast<std::uint64_t>(std::random_device{}()) << 32)};
+    return seed;
+}
+
+}  // namespace detail
+
+// seed of the run, std::random_device based unless set with seed().
+inline std::uint64_t current_seed() {
+    return detail::run_seed();
+}
+
+// stream i of the run seed: the seeded generator advanced by i * 2^128 steps, so streams never overlap.
+inline Xoshiro256ss stream(size_t i) {
+    Xoshiro256ss generator(current_seed());
+    for (size_t j{0}; j < i; ++j) {
+        generator.jump();
+    }
+    return generator;
+}
+
+inline Xoshiro256ss &generator() {
+    thread_local Xoshiro256ss generator = stream(0);
+    return generator;
+}
+
+// e.g. worker thread i (of a parallel run) calls use_stream(i) before drawing any random numbers.
+inline void use_stream(size_t i) {
+    generator() = stream(i);
+}
+
+// sets the run seed, and restarts the calling thread on stream 0.
+// Threads that already drew random numbers keep their old stream until they call use_stream.
+inline void seed(std::uint64_t seed) {
+    detail::run_seed() = seed;
+    use_stream(0);
+}
+
 // random integer in [a, b].
 inline primitives::point_id_t random_point(primitives::sequence_t a, primitives::sequence_t b) {
-    static std::random_device device; // will be used to obtain a seed for the random number engine
-    static std::mt19937 generator(device()); // standard mersenne_twister_engine seeded with random_device.
-    std::uniform_int_distribution<primitives::point_id_t> distribution(a, b);
-    return distribution(generator);
+    return a + generator().bounded(static_cast<std::uint64_t>(b - a) + 1);
 }
 
 inline primitives::sequence_t sequence(primitives::sequence_t max) {
     return random_point(0, max);
 }
 
-// selects at random k unique points in the range [start, end).
-// TODO: try to do better than O(end - start).
+// selects at random k unique points in the range [start, end), in ascending order.
+// Floyd's sampling: O(k) random numbers and O(k^2) comparisons, independent of end - start.
 inline std::vector<primitives::sequence_t> random_set(primitives::sequence_t start, primitives::sequence_t end, size_t k) {
-    const auto &n = end - start;
-    std::vector<primitives::sequence_t> candidates(n);
-    for (primitives::sequence_t s{0}; s < n; ++s) {
-        candidates[s] = s;
+    std::vector<primitives::sequence_t> selection;
+    selection.reserve(k);
+    for (auto j = end - k; j < end; ++j) {
+        const auto t = random_point(start, j);
+        const auto it = std::lower_bound(std::begin(selection), std::end(selection), t);
+        if (it != std::end(selection) and *it == t) {
+            // t was already selected; j was not, and is larger than every selection so far.
+            selection.push_back(j);
+        } else {
+            selection.insert(it, t);
+        }
     }
-    const auto &begin = std::begin(candidates);
-    std::random_shuffle(begin, std::end(candidates));
-    std::vector<primitives::sequence_t> selection(begin, begin + k);
-    std::sort(std::begin(selection), std::end(selection));
     return selection;
 }
 
+template <typename RandomIt>
+void shuffle(RandomIt first, RandomIt last) {
+    std::shuffle(first, last, generator());
+}
+
 inline bool random_bool() {
-    return (sequence(1) & 1) == 0;
+    return (generator()() >> 63) == 0;
 }
 
 }  // namespace randomize
-
-
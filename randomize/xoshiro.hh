@@ -0,0 +1,86 @@
+#pragma once
+
+// xoshiro256** pseudorandom number generator (Blackman and Vigna), seeded through splitmix64.
+// Much cheaper to step and to copy than std::mt19937 (32 bytes of state instead of 2.5 KB),
+// and satisfies UniformRandomBitGenerator, so it works with <random> distributions and std::shuffle.
+// jump() advances by 2^128 steps, which splits one seed into non-overlapping streams (e.g. one per thread).
+
+#include <cstdint>
+#include <limits>
+
+namespace randomize {
+
+class Xoshiro256ss {
+ public:
+    using result_type = std::uint64_t;
+
+    explicit Xoshiro256ss(std::uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(std::uint64_t seed) {
+        for (auto &s : state_) {
+            s = splitmix64(seed);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const auto result = rotl(state_[1] * 5, 7) * 9;
+        const auto t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    // equivalent to 2^128 calls to operator().
+    void jump() {
+        constexpr std::uint64_t JUMP[]{0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+        std::uint64_t jumped[4]{0, 0, 0, 0};
+        for (auto j : JUMP) {
+            for (int b{0}; b < 64; ++b) {
+                if (j & (std::uint64_t{1} << b)) {
+                    for (int i{0}; i < 4; ++i) {
+                        jumped[i] ^= state_[i];
+                    }
+                }
+                (*this)();
+            }
+        }
+        for (int i{0}; i < 4; ++i) {
+            state_[i] = jumped[i];
+        }
+    }
+
+    // uniform integer in [0, range), without division in the common case (Lemire's method).
+    std::uint64_t bounded(std::uint64_t range) {
+        __extension__ using uint128_t = unsigned __int128; // GCC / Clang extension, hence __extension__ for -pedantic.
+        auto product = static_cast<uint128_t>((*this)()) * range;
+        auto low = static_cast<std::uint64_t>(product);
+        if (low < range) {
+            const auto threshold = -range % range;
+            while (low < threshold) {
+                product = static_cast<uint128_t>((*this)()) * range;
+                low = static_cast<std::uint64_t>(product);
+            }
+        }
+        return static_cast<std::uint64_t>(product >> 64);
+    }
+
+ private:
+    std::uint64_t state_[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    static std::uint64_t splitmix64(std::uint64_t &x) {
+        auto z = (x += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+};
+
+}  // namespace randomize
@@ -0,0 +1,122 @@
+#pragma once
+
+// Relabels point ids along a space-filling curve so that spatially close points get close ids.
+// This improves memory locality of every per-point array (coordinates, tour adjacency,
+// search extents) during neighborhood searches.
+// Ids read from and written to files remain the original (file order) ids; see fileio.
+
+#include "point_quadtree/Domain.h"
+#include "point_quadtree/morton_keys.h"
+#include "primitives.hh"
+
+#include <algorithm> // sort
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility> // swap
+#include <vector>
+
+namespace relabel {
+
+enum class Curve { morton, hilbert };
+
+struct Relabeling {
+    std::vector<primitives::point_id_t> new_to_old; // new_to_old[new_id] = original id.
+    std::vector<primitives::point_id_t> old_to_new; // old_to_new[original_id] = new id.
+};
+
+inline Curve parse_curve(const std::string &name) {
+    if (name == "morton") {
+        return Curve::morton;
+    }
+    if (name == "hilbert") {
+        return Curve::hilbert;
+    }
+    throw std::invalid_argument("unrecognized relabel curve: " + name);
+}
+
+// distance along a Hilbert curve covering a (2^order x 2^order) grid.
+inline uint64_t hilbert_key(uint32_t x, uint32_t y, int order) {
+    const uint32_t n = static_cast<uint32_t>(1) << order;
+    uint64_t key{0};
+    for (uint32_t s = n >> 1; s > 0; s >>= 1) {
+        const uint32_t rx = (x & s) > 0;
+        const uint32_t ry = (y & s) > 0;
+        key += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        // rotate quadrant so that the curve is continuous.
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return key;
+}
+
+inline std::vector<uint64_t> hilbert_keys(const std::vector<primitives::space_t> &x
+    , const std::vector<primitives::space_t> &y
+    , const point_quadtree::Domain &domain) {
+    constexpr int ORDER{16};
+    constexpr primitives::space_t GRID_MAX((1 << ORDER) - 1);
+    std::vector<uint64_t> keys(x.size());
+    for (size_t i{0}; i < x.size(); ++i) {
+        const auto gx = static_cast<uint32_t>(GRID_MAX * (x[i] - domain.xmin()) / domain.xdim(0));
+        const auto gy = static_cast<uint32_t>(GRID_MAX * (y[i] - domain.ymin()) / domain.ydim(0));
+        keys[i] = hilbert_key(gx, gy, ORDER);
+    }
+    return keys;
+}
+
+inline Relabeling make_relabeling(const std::vector<primitives::space_t> &x
+    , const std::vector<primitives::space_t> &y
+    , Curve curve) {
+    const point_quadtree::Domain domain(x, y);
+    const auto keys = (curve == Curve::morton)
+        ? point_quadtree::morton_keys::compute_point_morton_keys(x, y, domain)
+        : hilbert_keys(x, y, domain);
+    Relabeling relabeling;
+    relabeling.new_to_old.resize(x.size());
+    for (primitives::point_id_t i{0}; i < x.size(); ++i) {
+        relabeling.new_to_old[i] = i;
+    }
+    // stable, so that ties keep file order and relabeling is deterministic.
+    std::stable_sort(std::begin(relabeling.new_to_old), std::end(relabeling.new_to_old)
+        , [&keys](auto lhs, auto rhs) { return keys[lhs] < keys[rhs]; });
+    relabeling.old_to_new.resize(x.size());
+    for (primitives::point_id_t i{0}; i < x.size(); ++i) {
+        relabeling.old_to_new[relabeling.new_to_old[i]] = i;
+    }
+    return relabeling;
+}
+
+// Permutes per-point values (e.g. coordinates) from original order to new order.
+template <typename T>
+void apply(const Relabeling &relabeling, std::vector<T> &values) {
+    std::vector<T> permuted(values.size());
+    for (size_t i{0}; i < values.size(); ++i) {
+        permuted[i] = values[relabeling.new_to_old[i]];
+    }
+    values = std::move(permuted);
+}
+
+// Maps original ids (e.g. read from a tour file) to new ids.
+inline std::vector<primitives::point_id_t> to_new(const Relabeling &relabeling
+    , std::vector<primitives::point_id_t> points) {
+    for (auto &p : points) {
+        p = relabeling.old_to_new[p];
+    }
+    return points;
+}
+
+// Maps new ids to original ids (e.g. for writing a tour file).
+inline std::vector<primitives::point_id_t> to_old(const Relabeling &relabeling
+    , std::vector<primitives::point_id_t> points) {
+    for (auto &p : points) {
+        p = relabeling.new_to_old[p];
+    }
+    return points;
+}
+
+}  // namespace relabel
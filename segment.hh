@@ -0,0 +1,144 @@
+#pragma once
+
+// Localized iterated local search on a window of consecutive tour points.
+// The window is optimized as an independent sub-instance (own quadtree, point set, tour and hill climber),
+// so that kicks, climbs and length comparisons cost O(window) instead of O(n).
+// The sub-tour is the window's path closed by a fixed edge between its last and first point,
+// so any improved sub-tour maps back to a path between the same endpoints, i.e. a valid move on the full tour.
+
+#include "edge.hh"
+#include "hill_climb.hh"
+#include "hill_climber.hh"
+#include "kmove.hh"
+#include "perturb.hh"
+#include "point_quadtree/Domain.h"
+#include "point_quadtree/GridPosition.h"
+#include "point_quadtree/node.hh"
+#include "point_quadtree/point_quadtree.h"
+#include "point_set.hh"
+#include "primitives.hh"
+#include "randomize/randomize.hh"
+#include "tour.hh"
+#include "trace_events.hh"
+
+#include <algorithm> // minmax_element
+#include <optional>
+#include <set>
+#include <vector>
+
+namespace segment {
+
+// Maps the improved sub-tour back to a move on the full tour.
+// points[i] is the full tour point of sub-instance point i; sub-instance points are in tour order.
+inline KMove to_kmove(const Tour &tour, const Tour &sub_tour, const std::vector<primitives::point_id_t> &points) {
+    const primitives::point_id_t last = points.size() - 1;
+    // walk the new path from the first to the last point, away from the fixed closing edge.
+    const bool forward = sub_tour.next(0) != last;
+    std::set<edge::Edge> old_edges, new_edges;
+    primitives::point_id_t current{0};
+    for (primitives::point_id_t i{0}; i < last; ++i) {
+        old_edges.insert(edge::make_edge(points[i], points[i + 1]));
+        const auto next = forward ? sub_tour.next(current) : sub_tour.prev(current);
+        new_edges.insert(edge::make_edge(points[current], points[next]));
+        current = next;
+    }
+    KMove kmove;
+    for (const auto &e : old_edges) {
+        if (new_edges.find(e) == std::cend(new_edges)) {
+            kmove.removes.push_back(tour.next(e.first) == e.second ? e.first : e.second);
+        }
+    }
+    for (const auto &e : new_edges) {
+        if (old_edges.find(e) == std::cend(old_edges)) {
+            kmove.starts.push_back(e.first);
+            kmove.ends.push_back(e.second);
+        }
+    }
+    return kmove;
+}
+
+// Runs kicks (kswap of kick_kmax edges) and climbs on the window of length points starting at start.
+// Returns a move that improves the full tour, or nothing if no kick improved the window.
+// Windows too short for a kick, or with zero extent in x or y (no quadtree domain), are skipped.
+template <typename Storage>
+std::optional<KMove> optimize(const Tour &tour
+    , primitives::point_id_t start
+    , primitives::point_id_t length
+    , size_t kmax
+    , size_t kick_kmax
+    , size_t kicks) {
+    length = std::min<primitives::point_id_t>(length, tour.size());
+    if (length < kick_kmax + 4) {
+        return std::nullopt;
+    }
+    std::vector<primitives::point_id_t> points(length);
+    std::vector<primitives::space_t> x(length), y(length);
+    auto p = start;
+    for (primitives::point_id_t i{0}; i < length; ++i) {
+        points[i] = p;
+        x[i] = tour.x(p);
+        y[i] = tour.y(p);
+        p = tour.next(p);
+    }
+    const auto [xmin, xmax] = std::minmax_element(std::cbegin(x), std::cend(x));
+    const auto [ymin, ymax] = std::minmax_element(std::cbegin(y), std::cend(y));
+    if (*xmin == *xmax or *ymin == *ymax) {
+        return std::nullopt;
+    }
+
+    // like point_quadtree::make_quadtree, but without validation and output.
+    const point_quadtree::Domain domain(x, y);
+    point_quadtree::Node root(point_quadtree::GridPosition(domain).make_box());
+    point_quadtree::insert_points(x, y, domain, root);
+    const BasicPointSet<Storage> point_set(root, x, y);
+
+    std::vector<primitives::point_id_t> path(length);
+    for (primitives::point_id_t i{0}; i < length; ++i) {
+        path[i] = i;
+    }
+    Tour best(&domain, path);
+    const auto initial_length = best.length();
+    // optional, since hill climbers (holding a point set reference) are not assignable.
+    std::optional<BasicHillClimber<BasicPointSet<Storage>>> best_hill_climber(point_set);
+    const primitives::point_id_t last = length - 1;
+    best_hill_climber->fix_edge(last, 0);
+    {
+        TRACE_SCOPE("climb");
+        hill_climb::climb(*best_hill_climber, best, kmax);
+    }
+    auto best_length = best.length();
+
+    for (size_t i{0}; i < kicks; ++i) {
+        KMove kick;
+        {
+            TRACE_SCOPE("kick");
+            kick = perturb::kswap(best.order(), randomize::sequence(last), kick_kmax);
+        }
+        const bool removes_fixed_edge = std::any_of(std::cbegin(kick.removes), std::cend(kick.removes)
+            , [&best, &best_hill_climber](auto r) { return best_hill_climber->fixed_edge(r, best.next(r)); });
+        if (removes_fixed_edge) {
+            continue;
+        }
+        auto tour_copy = best;
+        auto hill_climber_copy = *best_hill_climber;
+        {
+            TRACE_SCOPE("perturb");
+            tour_copy.swap(kick);
+            hill_climber_copy.changed(kick);
+        }
+        TRACE_SCOPE("climb");
+        hill_climb::climb(hill_climber_copy, tour_copy, kmax);
+        const auto new_length = tour_copy.length();
+        if (new_length < best_length) {
+            best = std::move(tour_copy);
+            best_hill_climber.emplace(std::move(hill_climber_copy));
+            best_length = new_length;
+        }
+    }
+    if (best_length >= initial_length) {
+        return std::nullopt;
+    }
+    return to_kmove(tour, best, points);
+}
+
+}  // namespace segment
@@ -0,0 +1,93 @@
+#pragma once
+
+// Persistent threads for the fork-join sections of the solver (parallel rounds, merge searches).
+// Threads are started once and reused by every section, so that their thread_local state (e.g. the merge
+// workspace, metric shards and trace event rows) lives as long as the pool instead of one section.
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility> // exchange
+#include <vector>
+
+namespace parallel {
+
+class ThreadPool {
+ public:
+    explicit ThreadPool(size_t threads) {
+        for (size_t t{0}; t < threads; ++t) {
+            threads_.emplace_back([this, t] { work(t); });
+        }
+    }
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        start_.notify_all();
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return threads_.size(); }
+
+    // Runs job(t) on every thread t (0 to size() - 1) and waits for all of them.
+    // Rethrows the first exception thrown by a job.
+    void run(const std::function<void(size_t)> &job) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        job_ = &job;
+        running_ = threads_.size();
+        ++generation_;
+        start_.notify_all();
+        done_.wait(lock, [this] { return running_ == 0; });
+        job_ = nullptr;
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+
+ private:
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(size_t)> *job_{nullptr};
+    size_t generation_{0}; // incremented by each run.
+    size_t running_{0}; // threads still running the current job.
+    std::exception_ptr error_;
+    bool stopping_{false};
+    std::vector<std::thread> threads_;
+
+    void work(size_t t) {
+        size_t generation{0};
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            start_.wait(lock, [this, &generation] { return stopping_ or generation_ != generation; });
+            if (stopping_) {
+                return;
+            }
+            generation = generation_;
+            const auto &job = *job_;
+            lock.unlock();
+            std::exception_ptr error;
+            try {
+                job(t);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            lock.lock();
+            if (error and not error_) {
+                error_ = error;
+            }
+            if (--running_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+};
+
+}  // namespace parallel
@@ -1,5 +1,9 @@
 #include "tour.hh"
 
+#include "metrics.hh"
+
+#include <utility> // pair
+
 Tour::Tour(const point_quadtree::Domain* domain
     , const std::vector<primitives::point_id_t>& initial_tour)
 : domain_(domain)
@@ -13,10 +17,76 @@ Tour::Tour(const point_quadtree::Domain* domain
 }
 
 void Tour::swap(const KMove& kmove) {
+    metrics::ScopedLatency latency(metrics::Latency::swap);
+    metrics::count(metrics::Count::tour_swaps);
     apply_kmove(kmove);
     update_next();
 }
 
+void Tour::swap_batch(const std::vector<KMove>& kmoves) {
+    metrics::ScopedLatency latency(metrics::Latency::swap);
+    metrics::count(metrics::Count::tour_swaps);
+    std::vector<primitives::point_id_t> removes;
+    for (const auto &kmove : kmoves) {
+        removes.insert(std::end(removes), std::cbegin(kmove.removes), std::cend(kmove.removes));
+    }
+    std::sort(std::begin(removes), std::end(removes));
+    if (std::adjacent_find(std::cbegin(removes), std::cend(removes)) != std::cend(removes)) {
+        throw std::logic_error("batched moves remove the same edge more than once.");
+    }
+    // every point must gain as many adjacents as it loses, so that fill_adjacent always finds a free slot.
+    std::vector<std::pair<primitives::point_id_t, int>> degree_changes;
+    for (auto r : removes) {
+        degree_changes.push_back({r, -1});
+        degree_changes.push_back({next_[r], -1});
+    }
+    for (const auto &kmove : kmoves) {
+        for (size_t i{0}; i < kmove.current_k(); ++i) {
+            degree_changes.push_back({kmove.starts[i], 1});
+            degree_changes.push_back({kmove.ends[i], 1});
+        }
+    }
+    std::sort(std::begin(degree_changes), std::end(degree_changes));
+    for (auto it = std::cbegin(degree_changes); it != std::cend(degree_changes);) {
+        int degree_change{0};
+        const auto point = it->first;
+        for (; it != std::cend(degree_changes) and it->first == point; ++it) {
+            degree_change += it->second;
+        }
+        if (degree_change != 0) {
+            throw std::logic_error("batched moves do not preserve the degree of every point.");
+        }
+    }
+    // the moves may still form several cycles, which only update_next detects; keep the changed
+    // adjacents to restore the tour in that case.
+    std::vector<std::pair<primitives::point_id_t, std::array<primitives::point_id_t, 2>>> changed;
+    for (const auto &change : degree_changes) {
+        if (changed.empty() or changed.back().first != change.first) {
+            changed.push_back({change.first, adjacents_[change.first]});
+        }
+    }
+    // next_ is only rebuilt at the end, so removes of every move still refer to the current tour.
+    for (const auto &kmove : kmoves) {
+        apply_kmove(kmove);
+    }
+    try {
+        update_next();
+    } catch (const std::logic_error &) {
+        for (const auto &[point, adjacents] : changed) {
+            adjacents_[point] = adjacents;
+        }
+        update_next();
+        throw;
+    }
+}
+
+void Tour::restore(const Tour &original, const Journal &journal) {
+    for (auto p : journal.points()) {
+        adjacents_[p] = original.adjacents_[p];
+    }
+    update_next();
+}
+
 void Tour::apply_kmove(const KMove &kmove) {
     for (auto p : kmove.removes) {
         break_adjacency(p);
@@ -129,6 +199,9 @@ void Tour::create_adjacency(primitives::point_id_t point1, primitives::point_id_
 }
 
 void Tour::fill_adjacent(primitives::point_id_t point, primitives::point_id_t new_adjacent) {
+    if (journal_) {
+        journal_->record(point);
+    }
     if (adjacents_[point].front() == constants::INVALID_POINT) {
         adjacents_[point].front() = new_adjacent;
     }
@@ -151,6 +224,9 @@ void Tour::break_adjacency(primitives::point_id_t point1, primitives::point_id_t
 }
 
 void Tour::vacate_adjacent_slot(primitives::point_id_t point, primitives::point_id_t adjacent) {
+    if (journal_) {
+        journal_->record(point);
+    }
     if (adjacents_[point][0] == adjacent) {
         adjacents_[point][0] = constants::INVALID_POINT;
     }
@@ -5,6 +5,7 @@
 #include "kmove.hh"
 #include "length_calculator.hh"
 #include "constants.h"
+#include "journal.hh"
 #include "point_quadtree/Domain.h"
 #include "point_quadtree/node.hh"
 #include "primitives.hh"
@@ -25,6 +26,11 @@ public:
         , const std::vector<primitives::point_id_t>& initial_tour);
 
     void swap(const KMove&);
+    // Applies independent moves (e.g. moves found in disjoint tour segments) with a single
+    // O(n) rebuild of next_, sequence_ and order_, instead of one rebuild per move.
+    // Throws std::logic_error, without changing the tour, if any edge is removed more than once,
+    // if any point would not keep two adjacents, or if the moves do not combine into a single cycle.
+    void swap_batch(const std::vector<KMove>&);
     template <typename SequenceContainer = std::vector<primitives::sequence_t>>
     KMove swap_sequence(SequenceContainer starts, SequenceContainer ends, SequenceContainer edges_to_remove);
 
@@ -58,6 +64,14 @@ public:
     // throws if invalid tour.
     void validate() const;
 
+    // Points whose adjacency changes are recorded in journal (nullptr to stop recording).
+    // Copies of the tour do not record (see JournalLink).
+    void set_journal(Journal *journal) { journal_ = journal; }
+    // Restores adjacency of journaled points from original (e.g. the tour this one was copied from),
+    // then rebuilds next_, sequence_ and order_ once. The result is identical to a copy of original
+    // if journal covers every point that differs.
+    void restore(const Tour &original, const Journal &journal);
+
     void print_first_cycle() const
     {
         constexpr primitives::point_id_t start {0};
@@ -109,6 +123,7 @@ protected:
     std::vector<primitives::point_id_t> order_;
     BoxMaker box_maker_;
     LengthCalculator length_calculator_;
+    JournalLink journal_;
 
     void reset_adjacencies(const std::vector<primitives::point_id_t>& initial_tour);
     void update_next(const primitives::point_id_t start = 0);
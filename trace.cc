@@ -0,0 +1,141 @@
+#include "trace.hh"
+
+#include "periodic_writer.hh"
+
+#include <chrono>
+#include <cstdlib> // atexit
+#include <fstream>
+#include <memory> // unique_ptr
+#include <mutex>
+#include <stdexcept>
+#include <utility> // move, pair, swap
+#include <vector>
+
+namespace trace {
+
+namespace detail {
+std::atomic<int> level{static_cast<int>(Level::off)};
+}  // namespace detail
+
+namespace {
+
+std::ofstream open_file(const std::string &path) {
+    std::ofstream file(path, std::ofstream::out);
+    if (not file) {
+        throw std::runtime_error("could not open trace file: " + path);
+    }
+    return file;
+}
+
+// Writes queued lines and dumps on a background thread, at least every FLUSH_INTERVAL.
+class Sink {
+ public:
+    explicit Sink(const std::string &path) : file_(open_file(path)) {}
+
+    void write(std::string line) {
+        bool wake{false};
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued_bytes_ += line.size();
+            lines_.push_back(std::move(line));
+            wake = queued_bytes_ > WAKE_BYTES;
+        }
+        if (wake) {
+            writer_.wake();
+        }
+    }
+
+    void dump(std::string path, std::string contents) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            dumps_.emplace_back(std::move(path), std::move(contents));
+        }
+        writer_.wake();
+    }
+
+ private:
+    static constexpr auto FLUSH_INTERVAL{std::chrono::milliseconds(200)};
+    static constexpr size_t WAKE_BYTES{1 << 16};
+
+    std::ofstream file_;
+    std::mutex mutex_;
+    size_t queued_bytes_{0};
+    std::vector<std::string> lines_;
+    std::vector<std::pair<std::string, std::string>> dumps_;
+    // swapped with the queues, then written outside of the lock.
+    std::vector<std::string> lines_out_;
+    std::vector<std::pair<std::string, std::string>> dumps_out_;
+    PeriodicWriter writer_{FLUSH_INTERVAL, [this] { flush(); }}; // last, so that it starts after the members it uses.
+
+    void flush() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::swap(lines_out_, lines_);
+            std::swap(dumps_out_, dumps_);
+            queued_bytes_ = 0;
+        }
+        for (const auto &line : lines_out_) {
+            file_ << line << '\n';
+        }
+        file_.flush();
+        lines_out_.clear();
+        for (const auto &[path, contents] : dumps_out_) {
+            std::ofstream(path, std::ofstream::out) << contents;
+        }
+        dumps_out_.clear();
+    }
+};
+
+std::mutex sink_mutex;
+std::unique_ptr<Sink> sink;
+
+}  // namespace
+
+Level parse_level(const std::string &name) {
+    if (name == "off") {
+        return Level::off;
+    }
+    if (name == "info") {
+        return Level::info;
+    }
+    if (name == "debug") {
+        return Level::debug;
+    }
+    if (name == "verbose") {
+        return Level::verbose;
+    }
+    throw std::invalid_argument("unknown trace level: " + name);
+}
+
+void open(const std::string &path, Level level) {
+    close();
+    {
+        std::lock_guard<std::mutex> lock(sink_mutex);
+        sink = std::make_unique<Sink>(path);
+    }
+    static const bool registered = std::atexit(close) == 0;
+    static_cast<void>(registered);
+    detail::level = static_cast<int>(level);
+}
+
+void close() {
+    detail::level = static_cast<int>(Level::off);
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    sink.reset();
+}
+
+void write(std::string line) {
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    if (sink) {
+        sink->write(std::move(line));
+    }
+}
+
+void dump(std::string path, std::string contents) {
+    std::lock_guard<std::mutex> lock(sink_mutex);
+    if (sink) {
+        sink->dump(std::move(path), std::move(contents));
+    }
+}
+
+}  // namespace trace
@@ -0,0 +1,59 @@
+#pragma once
+
+// Opt-in trace output for diagnostics on hot paths (e.g. merge and its combinator).
+// Messages above the compile-time level (TRACE_MAX_LEVEL, e.g. -DTRACE_MAX_LEVEL=0 in the makefile) are
+// compiled out; messages above the runtime level (set by open) are neither formatted nor written.
+// Lines and dumps are queued and written by a background thread, so tracing threads do no file I/O;
+// without an open sink nothing is traced.
+
+#include <atomic>
+#include <sstream>
+#include <string>
+
+#ifndef TRACE_MAX_LEVEL
+#define TRACE_MAX_LEVEL 3 // verbose.
+#endif
+
+namespace trace {
+
+enum class Level : int {
+    off = 0,
+    info = 1, // summaries, e.g. periodic merge telemetry.
+    debug = 2, // one or a few lines per merge.
+    verbose = 3 // per-exchange lines, edge and cycle dumps for plotting.
+};
+
+// "off", "info", "debug" or "verbose".
+Level parse_level(const std::string &name);
+
+namespace detail {
+extern std::atomic<int> level;
+}  // namespace detail
+
+constexpr bool compiled(Level level) { return static_cast<int>(level) <= TRACE_MAX_LEVEL; }
+
+inline bool enabled(Level level) {
+    return compiled(level) and static_cast<int>(level) <= detail::level.load(std::memory_order_relaxed);
+}
+
+// Starts writing lines at or below level to path; replaces an open sink.
+void open(const std::string &path, Level level);
+// Writes pending lines and dumps, and stops tracing.
+void close();
+
+// Queues a line of the trace file.
+void write(std::string line);
+// Queues contents to be written to their own file (overwritten), e.g. edge lists for plot_edges.py.
+void dump(std::string path, std::string contents);
+
+}  // namespace trace
+
+// Formats message (a stream insertion chain) only if level is enabled, e.g. TRACE(debug, "edges: " << n).
+#define TRACE(level, message) \
+    do { \
+        if (trace::enabled(trace::Level::level)) { \
+            std::ostringstream trace_message; \
+            trace_message << message; \
+            trace::write(trace_message.str()); \
+        } \
+    } while (false)
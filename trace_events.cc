@@ -0,0 +1,157 @@
+#include "trace_events.hh"
+
+#include "periodic_writer.hh"
+
+#include <algorithm> // find, min_element, remove_if
+#include <chrono>
+#include <cstdlib> // atexit
+#include <fstream>
+#include <iomanip> // setprecision
+#include <memory> // shared_ptr
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace trace {
+
+namespace detail {
+std::atomic<bool> events{false};
+NanoTimer epoch;
+}  // namespace detail
+
+namespace {
+
+struct Event {
+    const char *name;
+    std::uint64_t begin; // nanoseconds since open_events.
+    std::uint64_t end;
+};
+
+// Events of a thread; kept by the writer after the thread exits, until they are written.
+struct ThreadEvents {
+    size_t tid;
+    std::mutex mutex;
+    std::vector<Event> events;
+    bool exited{false};
+};
+
+std::mutex threads_mutex;
+std::vector<std::shared_ptr<ThreadEvents>> threads;
+// tids of exited threads, reused so that threads of successive pools (e.g. partitioners) share timeline rows.
+std::vector<size_t> free_tids;
+size_t tid_count{0};
+
+struct LocalEvents {
+    std::shared_ptr<ThreadEvents> events{std::make_shared<ThreadEvents>()};
+    LocalEvents() {
+        std::lock_guard<std::mutex> lock(threads_mutex);
+        if (free_tids.empty()) {
+            events->tid = ++tid_count;
+        } else {
+            events->tid = *std::min_element(std::cbegin(free_tids), std::cend(free_tids));
+            free_tids.erase(std::find(std::cbegin(free_tids), std::cend(free_tids), events->tid));
+        }
+        threads.push_back(events);
+    }
+    ~LocalEvents() {
+        std::lock_guard<std::mutex> lock(threads_mutex);
+        events->exited = true;
+        free_tids.push_back(events->tid);
+    }
+};
+
+ThreadEvents &local_events() {
+    thread_local LocalEvents local;
+    return *local.events;
+}
+
+std::ofstream open_file(const std::string &path) {
+    std::ofstream file(path, std::ofstream::out);
+    if (not file) {
+        throw std::runtime_error("could not open trace events file: " + path);
+    }
+    file << std::fixed << std::setprecision(3) << "[\n";
+    return file;
+}
+
+// Appends the events of all threads to the file at least every FLUSH_INTERVAL.
+class Writer {
+ public:
+    explicit Writer(const std::string &path) : file_(open_file(path)) {}
+    ~Writer() {
+        writer_.stop();
+        file_ << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"k-opt\"}}\n]\n";
+    }
+
+ private:
+    static constexpr auto FLUSH_INTERVAL{std::chrono::milliseconds(500)};
+
+    std::ofstream file_;
+    std::vector<Event> events_;
+    PeriodicWriter writer_{FLUSH_INTERVAL, [this] { write(); }}; // last, so that it starts after the members it uses.
+
+    void write() {
+        // threads that exited before the swap below, which then takes all of their events.
+        std::vector<std::shared_ptr<ThreadEvents>> current, exited;
+        {
+            std::lock_guard<std::mutex> lock(threads_mutex);
+            current = threads;
+            for (const auto &thread : threads) {
+                if (thread->exited) {
+                    exited.push_back(thread);
+                }
+            }
+        }
+        for (const auto &thread : current) {
+            {
+                std::lock_guard<std::mutex> lock(thread->mutex);
+                std::swap(events_, thread->events);
+            }
+            for (const auto &event : events_) {
+                file_ << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread->tid
+                    << ", \"ts\": " << event.begin / 1e3 << ", \"dur\": " << (event.end - event.begin) / 1e3 << "},\n";
+            }
+            events_.clear();
+        }
+        {
+            std::lock_guard<std::mutex> lock(threads_mutex);
+            threads.erase(std::remove_if(std::begin(threads), std::end(threads), [&exited](const auto &thread) {
+                return std::find(std::cbegin(exited), std::cend(exited), thread) != std::cend(exited);
+            }), std::end(threads));
+        }
+        file_.flush();
+    }
+};
+
+std::mutex writer_mutex;
+std::unique_ptr<Writer> writer;
+
+}  // namespace
+
+namespace detail {
+
+void record(const char *name, std::uint64_t begin, std::uint64_t end) {
+    auto &local = local_events();
+    std::lock_guard<std::mutex> lock(local.mutex);
+    local.events.push_back({name, begin, end});
+}
+
+}  // namespace detail
+
+void open_events(const std::string &path) {
+    close_events();
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    writer = std::make_unique<Writer>(path);
+    static const bool registered = std::atexit(close_events) == 0;
+    static_cast<void>(registered);
+    detail::epoch.start();
+    detail::events = true;
+}
+
+void close_events() {
+    detail::events = false;
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    writer.reset();
+}
+
+}  // namespace trace
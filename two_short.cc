@@ -82,7 +82,7 @@ std::set<edge::Edge> get_short_edges(const PointSet &point_set, const Tour &tour
 }
 
 KMove make_perturbation(const Tour &tour, std::vector<edge::Edge> &short_edges) {
-    std::random_shuffle(std::begin(short_edges), std::end(short_edges));
+    randomize::shuffle(std::begin(short_edges), std::end(short_edges));
     KMove large_kmove;
     std::unordered_set<primitives::point_id_t> removed;
     std::set<edge::Edge> added;
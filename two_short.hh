@@ -8,6 +8,7 @@
 #include "randomize/randomize.hh"
 
 #include <array>
+#include <optional>
 #include <random>
 #include <vector>
 #include <set>